@@ -0,0 +1,159 @@
+#include "backupservice.h"
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QUuid>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QDebug>
+#include <chrono>
+
+BackupService::BackupService(const QString &sourcePath, const QString &backupDir, int keep)
+    : sourcePath(sourcePath), backupDir(backupDir), baseName(QFileInfo(sourcePath).completeBaseName()),
+      keep(keep > 0 ? keep : DEFAULT_KEEP) {}
+
+BackupService::~BackupService() {
+    stop();
+}
+
+void BackupService::start(int intervalMs) {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = false;
+    }
+    worker = std::thread([this, intervalMs]() {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        while (!wakeUp.wait_for(lock, std::chrono::milliseconds(intervalMs), [this]() { return stopping; })) {
+            lock.unlock();
+            backupNow();
+            lock.lock();
+        }
+    });
+}
+
+void BackupService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+QString BackupService::backupNow() {
+    std::lock_guard<std::mutex> guard(backupMutex);
+    if (!QDir().mkpath(backupDir)) {
+        setError("Cannot create backup directory " + backupDir);
+        return QString();
+    }
+
+    QString target = nextSnapshotPath();
+    QString partial = target + ".partial";
+    QFile::remove(partial);
+
+    // 每次备份使用自己的连接，可在任意线程调用
+    const QString connection = "backup_" + QUuid::createUuid().toString(QUuid::WithoutBraces);
+    bool ok;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+        db.setDatabaseName(sourcePath);
+        db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+        ok = db.open();
+        if (!ok) {
+            setError("Cannot open database for backup: " + db.lastError().text());
+        } else {
+            QSqlQuery query(db);
+            query.prepare("VACUUM INTO ?");
+            query.addBindValue(partial);
+            ok = query.exec();
+            if (!ok) {
+                setError("Backup failed: " + query.lastError().text());
+            }
+            query.finish();
+            db.close();
+        }
+    }
+    QSqlDatabase::removeDatabase(connection);
+
+    // 先写 .partial，校验通过后再改名，快照目录中只会出现完整的备份
+    if (!ok || !verify(partial) || !QFile::rename(partial, target)) {
+        QFile::remove(partial);
+        qDebug() << "Backup of" << sourcePath << "failed:" << lastError();
+        return QString();
+    }
+
+    rotate();
+    qDebug() << "Backup written to" << target;
+    return target;
+}
+
+QString BackupService::nextSnapshotPath() const {
+    QDir dir(backupDir);
+    QString stamp = QDateTime::currentDateTime().toString("yyyyMMdd-HHmmsszzz");
+    // 同一毫秒内的多次备份用递增序号区分，文件名的字典序即时间顺序
+    QString path;
+    int n = 0;
+    do {
+        path = dir.filePath(QString("%1-%2-%3.db").arg(baseName, stamp).arg(n++, 2, 10, QChar('0')));
+    } while (QFile::exists(path));
+    return path;
+}
+
+bool BackupService::verify(const QString &snapshotPath) {
+    const QString connection = "backup_verify_" + QUuid::createUuid().toString(QUuid::WithoutBraces);
+    bool ok = false;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+        db.setDatabaseName(snapshotPath);
+        db.setConnectOptions("QSQLITE_OPEN_READONLY");
+        if (db.open()) {
+            QSqlQuery query(db);
+            if (query.exec("PRAGMA integrity_check") && query.next()) {
+                ok = (query.value(0).toString() == "ok");
+                if (!ok) {
+                    setError("Integrity check failed: " + query.value(0).toString());
+                }
+            } else {
+                setError("Integrity check failed: " + query.lastError().text());
+            }
+            query.finish();
+            db.close();
+        } else {
+            setError("Cannot open snapshot: " + db.lastError().text());
+        }
+    }
+    QSqlDatabase::removeDatabase(connection);
+    return ok;
+}
+
+QStringList BackupService::snapshots() const {
+    QDir dir(backupDir);
+    QStringList names = dir.entryList({baseName + "-*.db"}, QDir::Files, QDir::Name);
+    QStringList paths;
+    for (const QString &name : names) {
+        paths << dir.filePath(name);
+    }
+    return paths;
+}
+
+void BackupService::rotate() {
+    QStringList existing = snapshots();
+    for (int i = 0; i + keep < existing.size(); ++i) {
+        QFile::remove(existing[i]);
+    }
+}
+
+QString BackupService::lastError() const {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    return errorText;
+}
+
+void BackupService::setError(const QString &error) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    errorText = error;
+}
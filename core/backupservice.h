@@ -0,0 +1,54 @@
+#ifndef BACKUPSERVICE_H
+#define BACKUPSERVICE_H
+
+#include <QString>
+#include <QStringList>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// 在线备份服务。
+// 每次备份在独立的连接上执行 VACUUM INTO，得到一个事务一致的快照；
+// 数据库为 WAL 模式（createTables 设置），读快照不会阻塞写入，因此备份可以在营业时间运行。
+// 快照写完后用 PRAGMA integrity_check 校验，失败则删除；只保留最近 keep 份。
+// start() 后在后台线程按间隔定期备份，也可以随时调用 backupNow() 同步执行一次。
+class BackupService {
+public:
+    static const int DEFAULT_KEEP = 7;
+
+    BackupService(const QString &sourcePath, const QString &backupDir, int keep = DEFAULT_KEEP);
+    ~BackupService();
+
+    BackupService(const BackupService &) = delete;
+    BackupService &operator=(const BackupService &) = delete;
+
+    // 立即备份一次，成功返回快照路径，失败返回空字符串
+    QString backupNow();
+
+    void start(int intervalMs);
+    void stop();
+
+    // 现有快照，按时间从旧到新
+    QStringList snapshots() const;
+    QString lastError() const;
+
+private:
+    QString nextSnapshotPath() const;
+    bool verify(const QString &snapshotPath);
+    void rotate();
+    void setError(const QString &error);
+
+    QString sourcePath;
+    QString backupDir;
+    QString baseName;
+    int keep;
+
+    std::mutex backupMutex;         // 同一时间只运行一个备份
+    mutable std::mutex stateMutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+    QString errorText;
+    std::thread worker;
+};
+
+#endif // BACKUPSERVICE_H
@@ -0,0 +1,43 @@
+#include "changefeed.h"
+#include <QMutexLocker>
+
+ChangeFeed &ChangeFeed::instance() {
+    static ChangeFeed feed;
+    return feed;
+}
+
+int ChangeFeed::subscribe(Listener listener) {
+    QMutexLocker locker(&mutex);
+    int token = nextToken++;
+    listeners.emplace(token, std::move(listener));
+    return token;
+}
+
+void ChangeFeed::unsubscribe(int token) {
+    QMutexLocker locker(&mutex);
+    listeners.erase(token);
+}
+
+void ChangeFeed::publish(const ChangeEvent &event) {
+    publish(std::vector<ChangeEvent>{event});
+}
+
+void ChangeFeed::publish(const std::vector<ChangeEvent> &events) {
+    if (events.empty()) {
+        return;
+    }
+    // 先拷贝一份订阅者快照再回调，避免回调期间持锁
+    std::vector<Listener> snapshot;
+    {
+        QMutexLocker locker(&mutex);
+        snapshot.reserve(listeners.size());
+        for (const auto &entry : listeners) {
+            snapshot.push_back(entry.second);
+        }
+    }
+    for (const ChangeEvent &event : events) {
+        for (const Listener &listener : snapshot) {
+            listener(event);
+        }
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include <QMutex>
+#include <functional>
+#include <map>
+#include <vector>
+
+// 数据变更类型
+enum class ChangeType {
+    Insert,
+    Update,
+    Delete,
+    Reload   // 大批量变更（如全场调价），不逐条列出，productId 为 -1，订阅者整体刷新一次
+};
+
+// 变更所属的表
+enum class ChangeTable {
+    Products,
+    Orders
+};
+
+// 单条变更事件，只携带 productId（订单事件另带 customerId），订阅者按需自行取数
+struct ChangeEvent {
+    ChangeType type;
+    int productId;
+    ChangeTable table = ChangeTable::Products;
+    int customerId = -1;
+};
+
+// 进程内变更广播：仓储层（Product / Merchant / Customer）在写库成功后发布事件，
+// 缓存、索引和商品列表订阅后按增量更新，而不是整表重新加载。
+// 回调在发布者所在线程上同步调用，且不持有内部锁，回调中可以再订阅/退订。
+class ChangeFeed {
+public:
+    using Listener = std::function<void(const ChangeEvent &)>;
+
+    static ChangeFeed &instance();
+
+    // 订阅变更，返回用于退订的 token
+    int subscribe(Listener listener);
+    void unsubscribe(int token);
+
+    void publish(const ChangeEvent &event);
+    // 批量发布（如批量删除的一个分块），只取一次订阅者快照
+    void publish(const std::vector<ChangeEvent> &events);
+
+private:
+    ChangeFeed() = default;
+    ChangeFeed(const ChangeFeed &) = delete;
+    ChangeFeed &operator=(const ChangeFeed &) = delete;
+
+    QMutex mutex;
+    std::map<int, Listener> listeners;
+    int nextToken = 1;
+};
+
+#endif // CHANGEFEED_H
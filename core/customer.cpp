@@ -1,25 +1,46 @@
 #include "customer.h"
+#include "changefeed.h"
+#include "eventjournal.h"
+#include "hotqueries.h"
+#include "shardrouter.h"
+#include <QDateTime>
+#include <QHash>
 #include <QDebug>
 
-// 浏览产品
+// 浏览产品（按 productId 分页，每页走主键范围查找）
 void Customer::browseProducts(QSqlDatabase &db) {
+    const int pageSize = 500;
     QSqlQuery query(db);
-    query.exec("SELECT * FROM Products");
+    query.setForwardOnly(true);
+    query.prepare(HotQueries::PRODUCT_BROWSE_PAGE);
 
-    while (query.next()) {
-        int productId = query.value(0).toInt();
-        QString productName = query.value(1).toString();
-        float productPrice = query.value(3).toFloat();
-        qDebug() << "Product ID:" << productId
-                 << ", Product Name:" << productName
-                 << ", Price:" << productPrice;
+    int after = 0;
+    int rows = pageSize;
+    while (rows == pageSize) {
+        query.bindValue(":after", after);
+        query.bindValue(":limit", pageSize);
+        if (!query.exec()) {
+            qDebug() << "Error browsing products:" << query.lastError().text();
+            return;
+        }
+        rows = 0;
+        while (query.next()) {
+            int productId = query.value(0).toInt();
+            QString productName = query.value(1).toString();
+            float productPrice = query.value(2).toFloat();
+            qDebug() << "Product ID:" << productId
+                     << ", Product Name:" << productName
+                     << ", Price:" << productPrice;
+            after = productId;
+            ++rows;
+        }
     }
 }
 
 // 购买产品
 void Customer::purchaseProduct(QSqlDatabase &db, int productId) {
     QSqlQuery query(db);
-    query.prepare("SELECT name FROM Products WHERE productId = :productId");
+    query.prepare(HotQueries::PRODUCT_LIST_ROW);
     query.bindValue(":productId", productId);
 
     if (!query.exec()) {
@@ -28,14 +49,105 @@ void Customer::purchaseProduct(QSqlDatabase &db, int productId) {
     }
 
     if (query.next()) {
-        QString productName = query.value(0).toString();
+        QString productName = query.value(1).toString();
+
+        // 记录订单，连同下单时的商家和单价
+        QSqlQuery orderQuery(db);
+        orderQuery.prepare("INSERT INTO Orders (customerId, productId, quantity, orderDate, merchantId, unitPrice) "
+                           "VALUES (:customerId, :productId, 1, :orderDate, :merchantId, :unitPrice)");
+        orderQuery.bindValue(":customerId", userId);
+        orderQuery.bindValue(":productId", productId);
+        orderQuery.bindValue(":merchantId", query.value(3));
+        orderQuery.bindValue(":unitPrice", query.value(2));
+        orderQuery.bindValue(":orderDate", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+        if (!orderQuery.exec()) {
+            qDebug() << "Error recording order:" << orderQuery.lastError().text();
+            return;
+        }
+
         qDebug() << username << " purchased product:" << productName;
+        ChangeFeed::instance().publish({ChangeType::Insert, productId, ChangeTable::Orders, userId});
+        EventJournal::record(JournalEventType::OrderPlaced, {productId, userId, 1});
+    }
+}
+
+void Customer::purchaseProduct(ShardRouter &router, int productId) {
+    purchaseProduct(router.databaseForProduct(productId), productId);
+}
+
+OrderHistoryPage Customer::orderHistory(QSqlDatabase &db, int pageSize, const OrderCursor &after,
+                                       const QString &fromDate, const QString &toDate) const {
+    OrderHistoryPage page;
+    pageSize = qBound(1, pageSize, static_cast<int>(MAX_HISTORY_PAGE_SIZE));
+
+    // 空 QString 在 QSQLITE 中绑定为 NULL，比较永远不成立，因此不限日期时用哨兵值
+    static const QString MIN_ORDER_DATE = "0000-01-01T00:00:00Z";
+    static const QString MAX_ORDER_DATE = "9999-12-31T23:59:59Z";
+
+    // 游标与上界合并为一个行值比较：首页用 (toDate, 0)，即 orderDate < toDate
+    QString beforeDate = after.orderId > 0 ? after.orderDate : (toDate.isEmpty() ? MAX_ORDER_DATE : toDate);
+    int beforeId = after.orderId > 0 ? after.orderId : 0;
+
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(HotQueries::ORDER_HISTORY_PAGE);
+    query.bindValue(":customerId", userId);
+    query.bindValue(":fromDate", fromDate.isEmpty() ? MIN_ORDER_DATE : fromDate);
+    query.bindValue(":beforeDate", beforeDate);
+    query.bindValue(":beforeId", beforeId);
+    query.bindValue(":limit", pageSize + 1);  // 多取一条判断是否还有下一页
+    if (!query.exec()) {
+        qDebug() << "Error loading order history:" << query.lastError().text();
+        return page;
+    }
+    while (query.next()) {
+        if (page.orders.size() == pageSize) {
+            page.hasMore = true;
+            break;
+        }
+        page.orders.append({query.value(0).toInt(), query.value(1).toInt(), QString(),
+                            query.value(2).toInt(), query.value(3).toString()});
+    }
+    query.finish();
+    if (page.orders.isEmpty()) {
+        return page;
+    }
+    page.next = {page.orders.last().orderDate, page.orders.last().orderId};
+
+    // 本页涉及的商品名一次查出
+    QList<int> productIds;
+    for (const OrderHistoryEntry &entry : page.orders) {
+        if (!productIds.contains(entry.productId)) {
+            productIds.append(entry.productId);
+        }
+    }
+    QStringList placeholders;
+    for (int i = 0; i < productIds.size(); ++i) {
+        placeholders << "?";
+    }
+    QSqlQuery names(db);
+    names.setForwardOnly(true);
+    names.prepare(QString("SELECT productId, name FROM Products WHERE productId IN (%1)").arg(placeholders.join(", ")));
+    for (int productId : productIds) {
+        names.addBindValue(productId);
+    }
+    if (!names.exec()) {
+        qDebug() << "Error loading product names for order history:" << names.lastError().text();
+        return page;
+    }
+    QHash<int, QString> nameById;
+    while (names.next()) {
+        nameById.insert(names.value(0).toInt(), names.value(1).toString());
+    }
+    for (OrderHistoryEntry &entry : page.orders) {
+        entry.productName = nameById.value(entry.productId);
     }
+    return page;
 }
 
 // 注册用户
-void Customer::registerUser(QSqlDatabase &db) {
-    User::registerUser(db);  // 调用基类的注册函数
+RegistrationResult Customer::registerUser(QSqlDatabase &db) {
+    return User::registerUser(db);  // 调用基类的注册函数
 }
 
 // 登录用户
@@ -5,8 +5,34 @@
 #include "product.h"
 #include <QList>
 
+class ShardRouter;
+
+// 订单历史中的一条
+struct OrderHistoryEntry {
+    int orderId;
+    int productId;
+    QString productName;  // 商品已下架时为空
+    int quantity;
+    QString orderDate;    // ISO 格式（UTC）
+};
+
+// 翻页游标：上一页最后一条订单的 (orderDate, orderId)；默认值表示从最新的订单开始
+struct OrderCursor {
+    QString orderDate;
+    int orderId = 0;
+};
+
+struct OrderHistoryPage {
+    QList<OrderHistoryEntry> orders;
+    OrderCursor next;      // 下一页从这里继续
+    bool hasMore = false;
+};
+
 class Customer : public User {
 public:
+    static const int DEFAULT_HISTORY_PAGE_SIZE = 20;
+    static const int MAX_HISTORY_PAGE_SIZE = 500;
+
     Customer(int id, QString uname, QString pass, QString mail)
         : User(id, uname, pass, mail, "customer") {}
 
@@ -16,8 +42,18 @@ public:
     // 购买产品
     void purchaseProduct(QSqlDatabase &db, int productId);
 
+    // 分片存储：订单写入商品所在分片，与商家的商品放在一起
+    void purchaseProduct(ShardRouter &router, int productId);
+
+    // 订单历史，按时间从新到旧分页。
+    // 按 (orderDate, orderId) 游标翻页，走覆盖索引 idx_orders_customer_date，每页代价与历史长度无关；
+    // 商品名每页一次批量查询。fromDate（含）/toDate（不含）为 ISO 格式，空表示不限。
+    OrderHistoryPage orderHistory(QSqlDatabase &db, int pageSize = DEFAULT_HISTORY_PAGE_SIZE,
+                                  const OrderCursor &after = OrderCursor(),
+                                  const QString &fromDate = QString(), const QString &toDate = QString()) const;
+
     // 注册用户
-    void registerUser(QSqlDatabase &db) override;
+    RegistrationResult registerUser(QSqlDatabase &db) override;
 
     // 登录用户
     bool login(QSqlDatabase &db, const QString &inputPassword) override;
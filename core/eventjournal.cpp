@@ -0,0 +1,428 @@
+#include "eventjournal.h"
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+#include <QDebug>
+#include <chrono>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+std::mutex EventJournal::activeMutex;
+std::shared_ptr<EventJournal> EventJournal::activeJournal;
+
+namespace {
+
+const int HEADER_BYTES = 8;                  // 长度 + CRC
+const int BODY_FIXED_BYTES = 8 + 1 + 8;      // 序号 + 类型 + 时间戳
+const quint32 MAX_BODY_BYTES = 64 * 1024 * 1024;
+
+quint32 crc32(const char *data, qsizetype size) {
+    static quint32 table[256];
+    static bool initialized = [] {
+        for (quint32 i = 0; i < 256; ++i) {
+            quint32 c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            table[i] = c;
+        }
+        return true;
+    }();
+    (void)initialized;
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (qsizetype i = 0; i < size; ++i) {
+        crc = table[(crc ^ static_cast<quint8>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+QString segmentFileName(quint64 firstSequence) {
+    return QString("segment-%1.log").arg(firstSequence, 20, 10, QChar('0'));
+}
+
+quint64 segmentFirstSequence(const QString &path) {
+    QString name = QFileInfo(path).completeBaseName();  // segment-000...N
+    return name.mid(QString("segment-").size()).toULongLong();
+}
+
+// 序号补零，文件名字典序即序号顺序
+QStringList listSegments(const QString &directory) {
+    QDir dir(directory);
+    QStringList paths;
+    for (const QString &name : dir.entryList({"segment-*.log"}, QDir::Files, QDir::Name)) {
+        paths << dir.filePath(name);
+    }
+    return paths;
+}
+
+QByteArray encodeRecord(quint64 sequence, JournalEventType type, qint64 timestampMs, const QByteArray &payload) {
+    QByteArray body(BODY_FIXED_BYTES, Qt::Uninitialized);
+    qToLittleEndian<quint64>(sequence, body.data());
+    body[8] = static_cast<char>(type);
+    qToLittleEndian<qint64>(timestampMs, body.data() + 9);
+    body.append(payload);
+
+    QByteArray frame(HEADER_BYTES, Qt::Uninitialized);
+    qToLittleEndian<quint32>(static_cast<quint32>(body.size()), frame.data());
+    qToLittleEndian<quint32>(crc32(body.constData(), body.size()), frame.data() + 4);
+    frame.append(body);
+    return frame;
+}
+
+enum class ReadResult { Ok, End, Bad };
+
+ReadResult readRecord(QFile &file, JournalRecord &record) {
+    QByteArray header = file.read(HEADER_BYTES);
+    if (header.isEmpty()) {
+        return ReadResult::End;
+    }
+    if (header.size() < HEADER_BYTES) {
+        return ReadResult::Bad;  // 不完整的尾部
+    }
+    quint32 length = qFromLittleEndian<quint32>(header.constData());
+    quint32 crc = qFromLittleEndian<quint32>(header.constData() + 4);
+    if (length < static_cast<quint32>(BODY_FIXED_BYTES) || length > MAX_BODY_BYTES) {
+        return ReadResult::Bad;
+    }
+    QByteArray body = file.read(length);
+    if (body.size() != static_cast<qsizetype>(length) || crc32(body.constData(), body.size()) != crc) {
+        return ReadResult::Bad;
+    }
+    record.sequence = qFromLittleEndian<quint64>(body.constData());
+    record.type = static_cast<JournalEventType>(static_cast<quint8>(body[8]));
+    record.timestampMs = qFromLittleEndian<qint64>(body.constData() + 9);
+    record.payload = body.mid(BODY_FIXED_BYTES);
+    return ReadResult::Ok;
+}
+
+bool syncToDisk(QFile &file) {
+    if (!file.flush()) {
+        return false;
+    }
+#ifdef Q_OS_WIN
+    return _commit(file.handle()) == 0;
+#else
+    return fsync(file.handle()) == 0;
+#endif
+}
+
+} // namespace
+
+QVariantList JournalRecord::fields() const {
+    QVariantList values;
+    QDataStream stream(payload);
+    stream >> values;
+    return values;
+}
+
+EventJournal::EventJournal(const QString &directory, qint64 segmentBytes)
+    : directory(directory), segmentBytes(segmentBytes > 0 ? segmentBytes : DEFAULT_SEGMENT_BYTES) {}
+
+EventJournal::~EventJournal() {
+    close();
+}
+
+bool EventJournal::open() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (accepting) {
+        return true;
+    }
+    if (!QDir().mkpath(directory)) {
+        qDebug() << "Cannot create journal directory" << directory;
+        return false;
+    }
+
+    failed = false;
+    errorText.clear();
+    QStringList segments = listSegments(directory);
+    if (segments.isEmpty()) {
+        nextSequence = 1;
+        durableSequence = 0;
+        failed = !openSegment(1);
+    } else {
+        // 扫描最后一段，找到最后一条完整记录，截掉其后的残缺数据
+        QString last = segments.last();
+        quint64 lastSequence = segmentFirstSequence(last) - 1;
+        qint64 validEnd = 0;
+        {
+            QFile file(last);
+            if (!file.open(QIODevice::ReadWrite)) {
+                qDebug() << "Cannot open journal segment" << last << ":" << file.errorString();
+                return false;
+            }
+            JournalRecord record;
+            while (readRecord(file, record) == ReadResult::Ok) {
+                lastSequence = record.sequence;
+                validEnd = file.pos();
+            }
+            if (file.size() != validEnd) {
+                qDebug() << "Truncating torn journal tail in" << last << "at" << validEnd;
+                file.resize(validEnd);
+            }
+        }
+
+        nextSequence = lastSequence + 1;
+        durableSequence = lastSequence;
+        failed = !openSegment(segmentFirstSequence(last));
+    }
+    if (failed) {
+        errorText = segment.errorString();
+        return false;
+    }
+
+    accepting = true;
+    stopping = false;
+    writer = std::thread(&EventJournal::writerLoop, this);
+    return true;
+}
+
+void EventJournal::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        accepting = false;
+        stopping = true;
+    }
+    work.notify_all();
+    // 写线程先写完队列中剩余的记录再退出
+    if (writer.joinable()) {
+        writer.join();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    if (segment.isOpen()) {
+        syncToDisk(segment);
+        segment.close();
+    }
+}
+
+void EventJournal::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (failed) {
+            // 出错后按间隔重试；停止时立即再试最后一次
+            work.wait_for(lock, std::chrono::milliseconds(RETRY_INTERVAL_MS), [this]() { return stopping; });
+        } else {
+            work.wait(lock, [this]() { return stopping || !pending.isEmpty(); });
+        }
+        if (pending.isEmpty()) {
+            if (stopping) {
+                break;
+            }
+            continue;
+        }
+        // 组提交：一次带走排队中的全部记录，共享一次 fsync
+        flushing = true;
+        QByteArray batch;
+        batch.swap(pending);
+        quint64 batchFirst = pendingFirst;
+        quint64 batchLast = nextSequence - 1;
+        lock.unlock();
+
+        bool ok = writeBatch(batch, batchFirst);
+
+        lock.lock();
+        flushing = false;
+        if (ok) {
+            durableSequence = batchLast;
+            if (failed) {
+                qDebug() << "Journal writes resumed at sequence" << batchFirst;
+            }
+            failed = false;
+            errorText.clear();
+        } else {
+            failed = true;
+            errorText = segment.errorString();
+            quint64 count = batchLast - batchFirst + 1;
+            if (stopping) {
+                dropped += count;
+                qDebug() << "Journal closed with" << count << "unwritten records from sequence" << batchFirst
+                         << ":" << errorText;
+            } else {
+                // 整批放回队首，下次重试时按原序号写入
+                batch.append(pending);
+                pending.swap(batch);
+                pendingFirst = batchFirst;
+                qDebug() << "Journal write failed, retrying" << count << "records:" << errorText;
+            }
+        }
+        flushed.notify_all();
+    }
+}
+
+bool EventJournal::openSegment(quint64 firstSequence) {
+    if (segment.isOpen()) {
+        segment.close();
+    }
+    segment.setFileName(QDir(directory).filePath(segmentFileName(firstSequence)));
+    if (!segment.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qDebug() << "Cannot open journal segment" << segment.fileName() << ":" << segment.errorString();
+        return false;
+    }
+    segmentSize = segment.size();
+    return true;
+}
+
+// 只由写线程调用
+bool EventJournal::writeBatch(const QByteArray &batch, quint64 firstSequence) {
+    // 上次失败可能留下半批数据：截回最后一次成功写入的位置
+    if (segment.isOpen() && segment.size() != segmentSize && !segment.resize(segmentSize)) {
+        return false;
+    }
+    if (segmentSize > 0 && segmentSize + batch.size() > segmentBytes) {
+        syncToDisk(segment);
+        if (!openSegment(firstSequence)) {
+            return false;
+        }
+    }
+    if (!segment.isOpen() && !openSegment(firstSequence)) {
+        return false;
+    }
+    if (segment.write(batch) != batch.size() || !syncToDisk(segment)) {
+        qDebug() << "Error writing journal:" << segment.errorString();
+        return false;
+    }
+    segmentSize += batch.size();
+    return true;
+}
+
+quint64 EventJournal::enqueue(JournalEventType type, const QByteArray &payload) {
+    if (!accepting) {
+        return 0;
+    }
+    if (pending.size() >= MAX_PENDING_BYTES) {
+        ++dropped;
+        qDebug() << "Journal queue full, dropping record of type" << static_cast<int>(type) << ":" << errorText;
+        return 0;
+    }
+    quint64 sequence = nextSequence++;
+    if (pending.isEmpty()) {
+        pendingFirst = sequence;
+    }
+    pending.append(encodeRecord(sequence, type, QDateTime::currentMSecsSinceEpoch(), payload));
+    work.notify_one();
+    return sequence;
+}
+
+quint64 EventJournal::append(JournalEventType type, const QByteArray &payload) {
+    std::unique_lock<std::mutex> lock(mutex);
+    quint64 sequence = enqueue(type, payload);
+    if (sequence == 0) {
+        return 0;
+    }
+    flushed.wait(lock, [this, sequence]() { return durableSequence >= sequence || failed; });
+    return durableSequence >= sequence ? sequence : 0;
+}
+
+quint64 EventJournal::post(JournalEventType type, const QByteArray &payload) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return enqueue(type, payload);
+}
+
+bool EventJournal::healthy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !failed;
+}
+
+QString EventJournal::lastError() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return errorText;
+}
+
+quint64 EventJournal::droppedRecords() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+int EventJournal::retainSegments(int keepSegments) {
+    std::unique_lock<std::mutex> lock(mutex);
+    flushed.wait(lock, [this]() { return !flushing; });
+
+    QStringList closed = listSegments(directory);
+    closed.removeAll(segment.fileName());
+    int removed = 0;
+    for (int i = 0; i + qMax(keepSegments, 0) < closed.size(); ++i) {
+        if (QFile::remove(closed[i])) {
+            ++removed;
+        }
+    }
+    return removed;
+}
+
+QStringList EventJournal::segmentFiles() const {
+    return listSegments(directory);
+}
+
+void EventJournal::setActive(std::shared_ptr<EventJournal> journal) {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    activeJournal = std::move(journal);
+}
+
+std::shared_ptr<EventJournal> EventJournal::active() {
+    std::lock_guard<std::mutex> lock(activeMutex);
+    return activeJournal;
+}
+
+void EventJournal::record(JournalEventType type, const QVariantList &fields) {
+    std::shared_ptr<EventJournal> journal = active();
+    if (!journal) {
+        return;
+    }
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream << fields;
+    if (journal->post(type, payload) == 0) {
+        qDebug() << "Journal dropped event of type" << static_cast<int>(type);
+    }
+}
+
+JournalReader::JournalReader(const QString &directory, quint64 fromSequence)
+    : segments(listSegments(directory)), fromSequence(fromSequence) {
+    // 从首条序号不大于 fromSequence 的最后一段开始读
+    int start = 0;
+    for (int i = 1; i < segments.size(); ++i) {
+        if (segmentFirstSequence(segments[i]) > fromSequence) {
+            break;
+        }
+        start = i;
+    }
+    segmentIndex = start - 1;
+}
+
+bool JournalReader::openNextSegment() {
+    current.close();
+    if (++segmentIndex >= segments.size()) {
+        return false;
+    }
+    current.setFileName(segments[segmentIndex]);
+    return current.open(QIODevice::ReadOnly);
+}
+
+bool JournalReader::next(JournalRecord &record) {
+    while (!stopped) {
+        if (!current.isOpen() && !openNextSegment()) {
+            stopped = true;
+            break;
+        }
+        switch (readRecord(current, record)) {
+        case ReadResult::Ok:
+            if (record.sequence >= fromSequence) {
+                return true;
+            }
+            break;
+        case ReadResult::End:
+            current.close();
+            break;
+        case ReadResult::Bad:
+            qDebug() << "Journal replay stopped at damaged record in" << current.fileName();
+            stopped = true;
+            break;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,131 @@
+#ifndef EVENTJOURNAL_H
+#define EVENTJOURNAL_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// 日志事件类型
+enum class JournalEventType : quint8 {
+    Login = 1,             // userId, username, role
+    ProductPublished = 2,  // productId, merchantId, name, price
+    ProductRemoved = 3,    // productId, merchantId（未知时为空）
+    OrderPlaced = 4,       // productId, customerId, quantity
+    ProductsRemoved = 5,   // 批量删除的一个分块：[productId...]
+    PricesChanged = 6      // reason（reprice / campaign-start / campaign-end）, campaignId（无则 -1）, [productId...]
+};
+
+// 一条日志记录
+struct JournalRecord {
+    quint64 sequence = 0;
+    JournalEventType type = JournalEventType::Login;
+    qint64 timestampMs = 0;   // UTC 毫秒
+    QByteArray payload;
+
+    // 解码由 EventJournal::record() 写入的字段列表
+    QVariantList fields() const;
+};
+
+// 只追加的分段事件日志。
+// 记录写入 <dir>/segment-<首条序号>.log，单段超过 segmentBytes 后切到新段；
+// 每条记录的帧格式为 [长度 u32][CRC-32 u32][序号 u64][类型 u8][时间戳 i64][payload]（小端）。
+// 写盘和 fsync 只在 open() 启动的后台写线程里进行，采用组提交：排队的记录攒成一批写入并 fsync 一次。
+// append() 等待自己那条落盘；post() 只入队、立即返回，供 GUI 线程上的业务代码使用。
+// open() 会截掉上次崩溃留下的不完整尾部；close() 写完队列中的记录后停止写线程。
+// 写入或切段失败时，该批记录留在队列中，每隔 RETRY_INTERVAL_MS 重新打开段并重试，序号不跳号；
+// 期间 healthy() 为 false。队列超过 MAX_PENDING_BYTES 后新记录被丢弃并逐条记日志，
+// close() 时仍写不进去的记录同样计入 droppedRecords()。
+class EventJournal {
+public:
+    static const qint64 DEFAULT_SEGMENT_BYTES = 16 * 1024 * 1024;
+    static const int MAX_PENDING_BYTES = 8 * 1024 * 1024;
+    static const int RETRY_INTERVAL_MS = 1000;
+
+    explicit EventJournal(const QString &directory, qint64 segmentBytes = DEFAULT_SEGMENT_BYTES);
+    ~EventJournal();
+
+    EventJournal(const EventJournal &) = delete;
+    EventJournal &operator=(const EventJournal &) = delete;
+
+    bool open();
+    void close();
+
+    // 追加一条记录并等待落盘，返回序号；被拒绝或写盘失败返回 0（写盘失败的记录仍在队列中等待重试）
+    quint64 append(JournalEventType type, const QByteArray &payload);
+
+    // 追加一条记录但不等待落盘，返回分配的序号；日志未打开或队列已满时丢弃并返回 0
+    quint64 post(JournalEventType type, const QByteArray &payload);
+
+    // 最近一次写盘是否成功；失败期间 lastError() 给出原因
+    bool healthy() const;
+    QString lastError() const;
+    // 被丢弃的记录数
+    quint64 droppedRecords() const;
+
+    // 保留最近 keepSegments 个已写满的段，删除更早的段，返回删除数量；当前段不受影响
+    int retainSegments(int keepSegments);
+
+    QStringList segmentFiles() const;
+    QString directoryPath() const { return directory; }
+
+    // 进程内当前使用的日志（可为空）；业务代码通过 record() 写入，未设置时不记录。
+    // record() 持有日志的引用直到入队完成，setActive(nullptr) 之后日志对象不会在使用中被释放
+    static void setActive(std::shared_ptr<EventJournal> journal);
+    static std::shared_ptr<EventJournal> active();
+    static void record(JournalEventType type, const QVariantList &fields);
+
+private:
+    quint64 enqueue(JournalEventType type, const QByteArray &payload);   // 需持有 mutex
+    void writerLoop();
+    bool openSegment(quint64 firstSequence);
+    bool writeBatch(const QByteArray &batch, quint64 firstSequence);
+
+    QString directory;
+    qint64 segmentBytes;
+
+    mutable std::mutex mutex;
+    std::condition_variable work;     // 有新记录或需要停止
+    std::condition_variable flushed;  // 一批写完
+    QByteArray pending;               // 等待写入的记录
+    quint64 pendingFirst = 0;         // pending 中第一条的序号
+    quint64 nextSequence = 1;
+    quint64 durableSequence = 0;      // 已 fsync 的最大序号
+    bool accepting = false;           // open() 成功后到 close() 之前接受追加
+    bool stopping = false;
+    bool flushing = false;
+    bool failed = false;              // 最近一批写盘失败，等待重试
+    QString errorText;
+    quint64 dropped = 0;
+
+    std::thread writer;
+    QFile segment;                    // 当前段，open() 之后仅由写线程写
+    qint64 segmentSize = 0;
+
+    static std::mutex activeMutex;
+    static std::shared_ptr<EventJournal> activeJournal;
+};
+
+// 顺序回放读取器：按序号从小到大读取，遇到损坏或不完整的记录即停止
+class JournalReader {
+public:
+    explicit JournalReader(const QString &directory, quint64 fromSequence = 1);
+
+    bool next(JournalRecord &record);
+
+private:
+    bool openNextSegment();
+
+    QStringList segments;
+    int segmentIndex = -1;
+    quint64 fromSequence;
+    QFile current;
+    bool stopped = false;
+};
+
+#endif // EVENTJOURNAL_H
@@ -0,0 +1,55 @@
+#include "hotqueries.h"
+
+const char *const HotQueries::USER_LOGIN =
+    "SELECT password, salt, userId, hashAlgorithm, iterations FROM Users WHERE username = :username";
+
+const char *const HotQueries::USERNAME_EXISTS =
+    "SELECT 1 FROM Users WHERE username = :username LIMIT 1";
+
+const char *const HotQueries::PRODUCT_BY_ID =
+    "SELECT name, description, descriptionZ, price, image, merchantId FROM Products WHERE productId = :productId";
+
+const char *const HotQueries::PRODUCT_NAME_BY_ID =
+    "SELECT name FROM Products WHERE productId = :productId";
+
+// 列表行：与 Product::listProducts 相同的投影，不读描述和图片
+const char *const HotQueries::PRODUCT_LIST_ROW =
+    "SELECT productId, name, price, merchantId FROM Products WHERE productId = :productId";
+
+const char *const HotQueries::PRODUCT_DELETE =
+    "DELETE FROM Products WHERE productId = :productId";
+
+// 按主键分页（keyset），每页从上一页最后一个 productId 之后开始
+const char *const HotQueries::PRODUCT_BROWSE_PAGE =
+    "SELECT productId, name, price FROM Products WHERE productId > :after ORDER BY productId LIMIT :limit";
+
+// 顾客订单历史，按 (orderDate, orderId) 游标倒序分页，只读覆盖索引
+const char *const HotQueries::ORDER_HISTORY_PAGE =
+    "SELECT orderId, productId, quantity, orderDate FROM Orders "
+    "WHERE customerId = :customerId AND orderDate >= :fromDate "
+    "AND (orderDate, orderId) < (:beforeDate, :beforeId) "
+    "ORDER BY orderDate DESC, orderId DESC LIMIT :limit";
+
+// 活动结束时恢复原价：按 CampaignPrices 主键取出本活动商品，再按主键逐个更新，不扫描 Products。
+// 三个位置参数都是 campaignId；只恢复价格仍等于活动价的商品
+const char *const HotQueries::CAMPAIGN_REVERT =
+    "UPDATE Products SET price = "
+    "(SELECT cp.originalPrice FROM CampaignPrices cp WHERE cp.campaignId = ? AND cp.productId = Products.productId) "
+    "WHERE productId IN (SELECT productId FROM CampaignPrices WHERE campaignId = ?) "
+    "AND price = (SELECT cp.campaignPrice FROM CampaignPrices cp "
+    "WHERE cp.campaignId = ? AND cp.productId = Products.productId)";
+
+const QList<HotQuery> &HotQueries::all() {
+    static const QList<HotQuery> queries = {
+        {"User::login", USER_LOGIN, AccessPath::Index},
+        {"UserImporter", USERNAME_EXISTS, AccessPath::Index},
+        {"Product::getProductFromDB", PRODUCT_BY_ID, AccessPath::Index},
+        {"ProductTypeahead", PRODUCT_NAME_BY_ID, AccessPath::Index},
+        {"Product::getListRowFromDB / Customer::purchaseProduct", PRODUCT_LIST_ROW, AccessPath::Index},
+        {"Merchant::removeProduct / Product::deleteProductFromDB", PRODUCT_DELETE, AccessPath::Index},
+        {"Customer::browseProducts", PRODUCT_BROWSE_PAGE, AccessPath::Index},
+        {"Customer::orderHistory", ORDER_HISTORY_PAGE, AccessPath::Index},
+        {"Repricer::endCampaign", CAMPAIGN_REVERT, AccessPath::Index},
+    };
+    return queries;
+}
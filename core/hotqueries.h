@@ -0,0 +1,36 @@
+#ifndef HOTQUERIES_H
+#define HOTQUERIES_H
+
+#include <QList>
+
+// 热路径 SQL 的期望访问方式
+enum class AccessPath {
+    Index,     // 必须走索引/主键（EXPLAIN QUERY PLAN 中不允许出现 SCAN）
+    FullScan   // 允许全表扫描（需在登记时写明原因）
+};
+
+struct HotQuery {
+    const char *name;
+    const char *sql;
+    AccessPath expected;
+};
+
+// 热路径 SQL 的集中登记处。
+// 业务代码直接使用这里的语句常量，UnitTests 对 all() 中每条语句在种子库上跑 EXPLAIN QUERY PLAN，
+// 期望走索引却出现全表扫描时测试失败。新增热路径查询时须在此登记并声明访问方式。
+class HotQueries {
+public:
+    static const char *const USER_LOGIN;
+    static const char *const USERNAME_EXISTS;
+    static const char *const PRODUCT_BY_ID;
+    static const char *const PRODUCT_NAME_BY_ID;
+    static const char *const PRODUCT_LIST_ROW;
+    static const char *const PRODUCT_DELETE;
+    static const char *const PRODUCT_BROWSE_PAGE;
+    static const char *const ORDER_HISTORY_PAGE;
+    static const char *const CAMPAIGN_REVERT;
+
+    static const QList<HotQuery> &all();
+};
+
+#endif // HOTQUERIES_H
@@ -1,25 +1,56 @@
 #include "merchant.h"
+#include "changefeed.h"
+#include "eventjournal.h"
+#include "hotqueries.h"
+#include "productremover.h"
+#include "shardrouter.h"
 #include <QDebug>
 
 // 发布产品
 void Merchant::publishProduct(QSqlDatabase &db, const Product &product) {
     // Reuse Product insertion logic which validates and truncates descriptions as needed
-    product.insertProductToDB(db);
+    Product owned = product;
+    owned.setMerchantId(userId);
+    int productId = owned.insertProductToDB(db);
+    if (productId > 0) {
+        EventJournal::record(JournalEventType::ProductPublished, {productId, userId, owned.getName(), owned.getPrice()});
+    }
 }
 
 // 移除产品
 void Merchant::removeProduct(QSqlDatabase &db, int productId) {
     QSqlQuery query(db);
-    query.prepare("DELETE FROM Products WHERE productId = :productId");
+    query.prepare(HotQueries::PRODUCT_DELETE);
     query.bindValue(":productId", productId);
 
     if (!query.exec()) {
         qDebug() << "Error removing product:" << query.lastError().text();
     } else {
         qDebug() << "Product removed successfully!";
+        if (query.numRowsAffected() > 0) {
+            ChangeFeed::instance().publish({ChangeType::Delete, productId});
+            EventJournal::record(JournalEventType::ProductRemoved, {productId, userId});
+        }
     }
 }
 
+// 下架全部商品
+int Merchant::removeAllProducts(QSqlDatabase &db) {
+    return ProductRemover::removeProductsWhere(db, "merchantId = :merchantId", {{":merchantId", userId}});
+}
+
+void Merchant::publishProduct(ShardRouter &router, const Product &product) {
+    publishProduct(router.databaseForMerchant(userId), product);
+}
+
+void Merchant::removeProduct(ShardRouter &router, int productId) {
+    removeProduct(router.databaseForProduct(productId), productId);
+}
+
+int Merchant::removeAllProducts(ShardRouter &router) {
+    return removeAllProducts(router.databaseForMerchant(userId));
+}
+
 // 查看销售数据
 void Merchant::viewSalesData(QSqlDatabase &db) {
     // 这是一个简单示例，实际可能需要更复杂的查询
@@ -36,9 +67,21 @@ void Merchant::viewSalesData(QSqlDatabase &db) {
     }
 }
 
+// 导出销售数据
+bool Merchant::exportSalesData(QSqlDatabase &db, const QString &filePath, ExportFilter filter, ExportFormat format) {
+    // userId <= 0 在 ExportFilter 中表示“不过滤”，未登录的商家不能借此导出全部销售数据
+    if (userId <= 0) {
+        qDebug() << "Cannot export sales data: merchant has no userId";
+        return false;
+    }
+    filter.merchantId = userId;
+    OrderExporter exporter(db);
+    return exporter.exportSalesSummary(filePath, filter, format);
+}
+
 // 注册用户
-void Merchant::registerUser(QSqlDatabase &db) {
-    User::registerUser(db);  // 调用基类的注册函数
+RegistrationResult Merchant::registerUser(QSqlDatabase &db) {
+    return User::registerUser(db);  // 调用基类的注册函数
 }
 
 // 登录用户
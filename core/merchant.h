@@ -3,8 +3,11 @@
 
 #include "user.h"
 #include "product.h"
+#include "orderexporter.h"
 #include <QList>
 
+class ShardRouter;
+
 class Merchant : public User {
 public:
     Merchant(int id, QString uname, QString pass, QString mail)
@@ -16,11 +19,23 @@ public:
     // 移除产品
     void removeProduct(QSqlDatabase &db, int productId);
 
+    // 下架本商家的全部商品（分块事务删除），返回删除数量
+    int removeAllProducts(QSqlDatabase &db);
+
+    // 分片存储：商品写入本商家所在分片，删除按 productId 定位分片
+    void publishProduct(ShardRouter &router, const Product &product);
+    void removeProduct(ShardRouter &router, int productId);
+    int removeAllProducts(ShardRouter &router);
+
     // 查看销售数据
     void viewSalesData(QSqlDatabase &db);
 
+    // 导出本商家的销售汇总到文件（按 filter 的日期范围过滤）
+    bool exportSalesData(QSqlDatabase &db, const QString &filePath, ExportFilter filter,
+                         ExportFormat format = ExportFormat::Csv);
+
     // 注册用户
-    void registerUser(QSqlDatabase &db) override;
+    RegistrationResult registerUser(QSqlDatabase &db) override;
 
     // 登录用户
     bool login(QSqlDatabase &db, const QString &inputPassword) override;
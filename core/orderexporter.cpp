@@ -0,0 +1,280 @@
+#include "orderexporter.h"
+#include <QFile>
+#include <QDataStream>
+#include <QStringList>
+#include <QVariantList>
+#include <QtSql/QSqlError>
+#include <QtSql/QSqlRecord>
+#include <QDebug>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// 列分块二进制格式的文件头标识与版本
+const char COLUMN_CHUNK_MAGIC[] = "SLCX";
+const quint16 COLUMN_CHUNK_VERSION = 1;
+
+// 双缓冲写线程：读线程 submit() 一块数据后即可继续编码下一块，
+// 写线程落盘上一块；写线程未取走时 submit() 会阻塞，所以最多两块在途。
+class DoubleBufferedWriter {
+public:
+    explicit DoubleBufferedWriter(QFile &file)
+        : file(file), worker([this]() { run(); }) {}
+
+    ~DoubleBufferedWriter() { finish(); }
+
+    void submit(QByteArray chunk) {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this]() { return !hasPending; });
+        pending = std::move(chunk);
+        hasPending = true;
+        ready.notify_one();
+    }
+
+    // 等待所有数据写完并结束写线程，返回是否全部写入成功
+    bool finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            done = true;
+        }
+        ready.notify_one();
+        if (worker.joinable()) {
+            worker.join();
+        }
+        return ok;
+    }
+
+private:
+    void run() {
+        for (;;) {
+            QByteArray chunk;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this]() { return hasPending || done; });
+                if (!hasPending) {
+                    return;
+                }
+                chunk = std::move(pending);
+                hasPending = false;
+            }
+            drained.notify_one();
+            if (ok && file.write(chunk) != chunk.size()) {
+                ok = false;
+            }
+        }
+    }
+
+    QFile &file;
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::condition_variable drained;
+    QByteArray pending;
+    bool hasPending = false;
+    bool done = false;
+    bool ok = true;
+    std::thread worker;  // 最后初始化，保证其余成员已就绪
+};
+
+QString csvField(const QVariant &value) {
+    QString text = value.toString();
+    if (text.contains(',') || text.contains('"') || text.contains('\n') || text.contains('\r')) {
+        text.replace("\"", "\"\"");
+        return "\"" + text + "\"";
+    }
+    return text;
+}
+
+QByteArray encodeCsvHeader(const QStringList &columns) {
+    return (columns.join(',') + "\n").toUtf8();
+}
+
+QByteArray encodeCsvChunk(const std::vector<QVariantList> &columns, int rows) {
+    QString text;
+    for (int row = 0; row < rows; ++row) {
+        for (size_t col = 0; col < columns.size(); ++col) {
+            if (col > 0) {
+                text += ',';
+            }
+            text += csvField(columns[col][row]);
+        }
+        text += '\n';
+    }
+    return text.toUtf8();
+}
+
+// 文件头：magic, version, 列名；之后每块：行数 + 每列一段 qCompress 数据；行数 0 表示结束
+QByteArray encodeColumnHeader(const QStringList &columns) {
+    QByteArray out;
+    QDataStream stream(&out, QIODevice::WriteOnly);
+    stream.writeRawData(COLUMN_CHUNK_MAGIC, 4);
+    stream << COLUMN_CHUNK_VERSION << columns;
+    return out;
+}
+
+QByteArray encodeColumnChunk(const std::vector<QVariantList> &columns, int rows) {
+    QByteArray out;
+    QDataStream stream(&out, QIODevice::WriteOnly);
+    stream << static_cast<quint32>(rows);
+    for (const QVariantList &column : columns) {
+        QByteArray raw;
+        QDataStream columnStream(&raw, QIODevice::WriteOnly);
+        columnStream << column;
+        stream << qCompress(raw);
+    }
+    return out;
+}
+
+QByteArray encodeColumnFooter() {
+    QByteArray out;
+    QDataStream stream(&out, QIODevice::WriteOnly);
+    stream << static_cast<quint32>(0);
+    return out;
+}
+
+} // namespace
+
+bool OrderExporter::prepareFiltered(QSqlQuery &query, const QString &select, const QString &tail, const ExportFilter &filter) {
+    QStringList conditions;
+    if (filter.merchantId > 0) {
+        // 下单时记录的商家优先，旧订单（NULL）退回到商品表
+        conditions << "COALESCE(o.merchantId, p.merchantId) = :merchantId";
+    }
+    if (!filter.fromDate.isEmpty()) {
+        conditions << "o.orderDate >= :fromDate";
+    }
+    if (!filter.toDate.isEmpty()) {
+        conditions << "o.orderDate < :toDate";
+    }
+
+    QString sql = select;
+    if (!conditions.isEmpty()) {
+        sql += " WHERE " + conditions.join(" AND ");
+    }
+    sql += " " + tail;
+
+    // forward-only：驱动不缓存已读行，逐行流式读取
+    query.setForwardOnly(true);
+    if (!query.prepare(sql)) {
+        errorText = query.lastError().text();
+        return false;
+    }
+    if (filter.merchantId > 0) {
+        query.bindValue(":merchantId", filter.merchantId);
+    }
+    if (!filter.fromDate.isEmpty()) {
+        query.bindValue(":fromDate", filter.fromDate);
+    }
+    if (!filter.toDate.isEmpty()) {
+        query.bindValue(":toDate", filter.toDate);
+    }
+    return true;
+}
+
+bool OrderExporter::exportOrders(const QString &filePath, const ExportFilter &filter, ExportFormat format) {
+    QSqlQuery query(db);
+    if (!prepareFiltered(query,
+                         "SELECT o.orderId, o.customerId, o.productId, p.name AS productName, o.quantity, o.orderDate "
+                         "FROM Orders o LEFT JOIN Products p ON p.productId = o.productId",
+                         "ORDER BY o.orderId", filter)) {
+        qDebug() << "Error preparing order export:" << errorText;
+        return false;
+    }
+    return stream(query, filePath, format);
+}
+
+bool OrderExporter::exportSalesSummary(const QString &filePath, const ExportFilter &filter, ExportFormat format) {
+    QSqlQuery query(db);
+    if (!prepareFiltered(query,
+                         "SELECT o.productId, p.name AS productName, COUNT(*) AS orders, "
+                         "SUM(o.quantity) AS unitsSold, SUM(o.quantity * COALESCE(o.unitPrice, p.price, 0)) AS revenue "
+                         "FROM Orders o LEFT JOIN Products p ON p.productId = o.productId",
+                         "GROUP BY o.productId ORDER BY o.productId", filter)) {
+        qDebug() << "Error preparing sales export:" << errorText;
+        return false;
+    }
+    return stream(query, filePath, format);
+}
+
+bool OrderExporter::stream(QSqlQuery &query, const QString &filePath, ExportFormat format) {
+    exportedRows = 0;
+    errorText.clear();
+
+    if (!query.exec()) {
+        errorText = query.lastError().text();
+        qDebug() << "Error running export query:" << errorText;
+        return false;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        errorText = file.errorString();
+        qDebug() << "Error opening export file:" << errorText;
+        return false;
+    }
+
+    QSqlRecord record = query.record();
+    QStringList columnNames;
+    for (int i = 0; i < record.count(); ++i) {
+        columnNames << record.fieldName(i);
+    }
+    const bool csv = (format == ExportFormat::Csv);
+
+    bool written;
+    QSqlError stepError;
+    {
+        DoubleBufferedWriter writer(file);
+        writer.submit(csv ? encodeCsvHeader(columnNames) : encodeColumnHeader(columnNames));
+
+        std::vector<QVariantList> columns(columnNames.size());
+        for (QVariantList &column : columns) {
+            column.reserve(batchRows);
+        }
+        int rows = 0;
+        auto flush = [&]() {
+            writer.submit(csv ? encodeCsvChunk(columns, rows) : encodeColumnChunk(columns, rows));
+            for (QVariantList &column : columns) {
+                column.clear();
+            }
+            exportedRows += rows;
+            rows = 0;
+        };
+
+        while (query.next()) {
+            for (int i = 0; i < static_cast<int>(columns.size()); ++i) {
+                columns[i].append(query.value(i));
+            }
+            if (++rows == batchRows) {
+                flush();
+            }
+        }
+        // next() 返回 false 也可能是读取出错（SQLITE_BUSY、I/O），不能当作读完
+        stepError = query.lastError();
+        if (!stepError.isValid()) {
+            if (rows > 0) {
+                flush();
+            }
+            if (!csv) {
+                writer.submit(encodeColumnFooter());
+            }
+        }
+        written = writer.finish();
+    }
+    query.finish();
+
+    if (stepError.isValid()) {
+        errorText = stepError.text();
+        qDebug() << "Error reading export rows:" << errorText;
+        file.remove();  // 不留下被截断的导出文件
+        return false;
+    }
+    if (!written) {
+        errorText = file.errorString();
+        qDebug() << "Error writing export file:" << errorText;
+        return false;
+    }
+    qDebug() << "Exported" << exportedRows << "rows to" << filePath;
+    return true;
+}
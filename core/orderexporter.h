@@ -0,0 +1,52 @@
+#ifndef ORDEREXPORTER_H
+#define ORDEREXPORTER_H
+
+#include <QString>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+// 导出过滤条件
+struct ExportFilter {
+    int merchantId = -1;    // 只导出该商家的商品（<= 0 表示不过滤）
+    QString fromDate;       // orderDate 下界（含），ISO 格式，空表示不限
+    QString toDate;         // orderDate 上界（不含），ISO 格式，空表示不限
+};
+
+// 导出格式
+enum class ExportFormat {
+    Csv,            // 逗号分隔文本，首行为列名
+    ColumnChunked   // 按批次分块、按列 qCompress 压缩的二进制格式
+};
+
+// 订单与销售汇总的流式导出器。
+// 查询以 forward-only 方式逐批读取（每批 batchRows 行），编码后交给后台写线程；
+// 读线程与写线程之间最多两块缓冲在途，因此内存占用与导出行数无关。
+// 商家过滤与销售额使用订单上记录的 merchantId / unitPrice，商品之后改价或下架不影响结果；
+// 这两列加入之前的旧订单为 NULL，只能按商品表的当前商家和当前价格计算（商品已删除时不计入商家、金额为 0）。
+class OrderExporter {
+public:
+    static const int DEFAULT_BATCH_ROWS = 4096;
+
+    explicit OrderExporter(QSqlDatabase &db, int batchRows = DEFAULT_BATCH_ROWS)
+        : db(db), batchRows(batchRows > 0 ? batchRows : DEFAULT_BATCH_ROWS) {}
+
+    // 导出订单明细：orderId, customerId, productId, productName, quantity, orderDate
+    bool exportOrders(const QString &filePath, const ExportFilter &filter, ExportFormat format);
+
+    // 导出按商品汇总的销售数据：productId, productName, orders, unitsSold, revenue
+    bool exportSalesSummary(const QString &filePath, const ExportFilter &filter, ExportFormat format);
+
+    qint64 rowsExported() const { return exportedRows; }
+    QString lastError() const { return errorText; }
+
+private:
+    bool prepareFiltered(QSqlQuery &query, const QString &select, const QString &tail, const ExportFilter &filter);
+    bool stream(QSqlQuery &query, const QString &filePath, ExportFormat format);
+
+    QSqlDatabase &db;
+    int batchRows;
+    qint64 exportedRows = 0;
+    QString errorText;
+};
+
+#endif // ORDEREXPORTER_H
@@ -1,4 +1,7 @@
 #include "product.h"
+#include "changefeed.h"
+#include "hotqueries.h"
+#include "eventjournal.h"
 #include <QDebug>
 #include <cstring>
 
@@ -29,7 +32,28 @@ bool parseProductDescriptionToQString(const char* input, QString &out, QString &
     return true;
 }
 
-void Product::insertProductToDB(QSqlDatabase &db) const {
+// 长描述压缩存储：短描述存 description 列，长描述存 descriptionZ 列（qCompress）
+static void bindDescription(QSqlQuery &query, const QString &description) {
+    QByteArray utf8 = description.toUtf8();
+    if (utf8.size() > Product::DESCRIPTION_COMPRESS_THRESHOLD) {
+        query.bindValue(":description", QVariant());
+        query.bindValue(":descriptionZ", qCompress(utf8));
+    } else {
+        query.bindValue(":description", description);
+        query.bindValue(":descriptionZ", QVariant());
+    }
+}
+
+static QString readDescription(const QSqlQuery &query) {
+    QVariant compressed = query.value("descriptionZ");
+    if (!compressed.isNull()) {
+        return QString::fromUtf8(qUncompress(compressed.toByteArray()));
+    }
+    return query.value("description").toString();
+}
+
+int Product::insertProductToDB(QSqlDatabase &db) const {
+    loadDetails();
     QString descToStore = description;
     QString err;
     if (description.startsWith("DESC:")) {
@@ -37,7 +61,7 @@ void Product::insertProductToDB(QSqlDatabase &db) const {
         if (!ok) {
             qDebug() << "Product description invalid:" << err;
             // Decide: reject insertion or store empty description. Here we reject insertion to prevent bad data.
-            return;
+            return -1;
         }
         if (!err.isEmpty()) {
             qDebug() << err;
@@ -45,24 +69,28 @@ void Product::insertProductToDB(QSqlDatabase &db) const {
     }
 
     QSqlQuery query(db);
-    query.prepare("INSERT INTO Products (name, description, price, image) "
-                  "VALUES (:name, :description, :price, :image)");
+    query.prepare("INSERT INTO Products (name, description, descriptionZ, price, image, merchantId) "
+                  "VALUES (:name, :description, :descriptionZ, :price, :image, :merchantId)");
     query.bindValue(":name", name);
-    query.bindValue(":description", descToStore);
+    bindDescription(query, descToStore);
     query.bindValue(":price", price);
     query.bindValue(":image", image);
+    query.bindValue(":merchantId", merchantId > 0 ? QVariant(merchantId) : QVariant());
 
     if (!query.exec()) {
         qDebug() << "Error inserting product:" << query.lastError().text();
-    } else {
-        qDebug() << "Product inserted successfully!";
+        return -1;
     }
+    qDebug() << "Product inserted successfully!";
+    int newId = query.lastInsertId().toInt();
+    ChangeFeed::instance().publish({ChangeType::Insert, newId});
+    return newId;
 }
 
 // 从数据库中获取商品信息
 Product Product::getProductFromDB(QSqlDatabase &db, int productId) {
     QSqlQuery query(db);
-    query.prepare("SELECT * FROM Products WHERE productId = :productId");
+    query.prepare(HotQueries::PRODUCT_BY_ID);
     query.bindValue(":productId", productId);
 
     if (!query.exec()) {
@@ -72,31 +100,100 @@ Product Product::getProductFromDB(QSqlDatabase &db, int productId) {
 
     if (query.next()) {
         QString name = query.value("name").toString();
-        QString description = query.value("description").toString();
+        QString description = readDescription(query);
         float price = query.value("price").toFloat();
         QString image = query.value("image").toString();
 
-        return Product(productId, name, description, price, image);
+        Product product(productId, name, description, price, image);
+        if (!query.value("merchantId").isNull()) {
+            product.setMerchantId(query.value("merchantId").toInt());
+        }
+        return product;
     }
 
     return Product(-1, "", "", 0.0, "");  // 返回一个空的 Product 对象
 }
 
+// 列表查询：只投影列表显示需要的列
+QList<Product> Product::listProducts(QSqlDatabase &db) {
+    QList<Product> products;
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT productId, name, price, merchantId FROM Products")) {
+        qDebug() << "Error listing products:" << query.lastError().text();
+        return products;
+    }
+
+    while (query.next()) {
+        products.append(fromListRow(query, db));
+    }
+    return products;
+}
+
+Product Product::getListRowFromDB(QSqlDatabase &db, int productId) {
+    QSqlQuery query(db);
+    query.prepare(HotQueries::PRODUCT_LIST_ROW);
+    query.bindValue(":productId", productId);
+    if (!query.exec()) {
+        qDebug() << "Error fetching product row:" << query.lastError().text();
+        return Product(-1, "", "", 0.0, "");
+    }
+    if (query.next()) {
+        return fromListRow(query, db);
+    }
+    return Product(-1, "", "", 0.0, "");
+}
+
+Product Product::fromListRow(const QSqlQuery &query, QSqlDatabase &db) {
+    Product product(query.value(0).toInt(), query.value(1).toString(), "", query.value(2).toFloat(), "");
+    if (!query.value(3).isNull()) {
+        product.merchantId = query.value(3).toInt();
+    }
+    product.detailsLoaded = false;
+    product.detailSource = db;
+    return product;
+}
+
+// 首次访问描述/图片时再从数据库读取（长描述此时才解压）
+void Product::loadDetails() const {
+    if (detailsLoaded) {
+        return;
+    }
+    detailsLoaded = true;
+
+    QSqlQuery query(detailSource);
+    query.prepare("SELECT description, descriptionZ, image FROM Products WHERE productId = :productId");
+    query.bindValue(":productId", productId);
+    if (!query.exec()) {
+        qDebug() << "Error loading product details:" << query.lastError().text();
+        return;
+    }
+    if (query.next()) {
+        description = readDescription(query);
+        image = query.value("image").toString();
+    }
+}
+
 // 从数据库中删除商品
 void Product::deleteProductFromDB(QSqlDatabase &db, int productId) {
     QSqlQuery query(db);
-    query.prepare("DELETE FROM Products WHERE productId = :productId");
+    query.prepare(HotQueries::PRODUCT_DELETE);
     query.bindValue(":productId", productId);
 
     if (!query.exec()) {
         qDebug() << "Error deleting product:" << query.lastError().text();
     } else {
         qDebug() << "Product deleted successfully!";
+        if (query.numRowsAffected() > 0) {
+            ChangeFeed::instance().publish({ChangeType::Delete, productId});
+            EventJournal::record(JournalEventType::ProductRemoved, {productId, QVariant()});
+        }
     }
 }
 
 // 显示商品信息
 void Product::displayProduct() const {
+    loadDetails();
     qDebug() << "Product ID:" << productId
              << ", Name:" << name
              << ", Description:" << description
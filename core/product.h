@@ -5,19 +5,32 @@
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlQuery>
 #include <QtSql/QSqlError>
+#include <QList>
 
 class Product {
 private:
     int productId;          // 商品ID
     QString name;           // 商品名称
-    QString description;    // 商品描述
+    mutable QString description;    // 商品描述（列表查询得到的商品首次访问时才加载）
     float price;            // 商品价格
-    QString image;          // 商品图片路径
+    mutable QString image;  // 商品图片路径（同上）
+    int merchantId;         // 所属商家ID（未知为 -1）
+
+    mutable bool detailsLoaded;     // description / image 是否已加载
+    QSqlDatabase detailSource;      // 延迟加载所用的连接
+
+    void loadDetails() const;
+    // 由 productId / name / price / merchantId 四列构造，描述和图片延迟加载
+    static Product fromListRow(const QSqlQuery &query, QSqlDatabase &db);
 
 public:
+    // 超过该长度（UTF-8 字节）的描述压缩后存入 descriptionZ 列
+    static const int DESCRIPTION_COMPRESS_THRESHOLD = 512;
+
     // 构造函数
     Product(int id, QString productName, QString productDescription, float productPrice, QString productImage)
-        : productId(id), name(productName), description(productDescription), price(productPrice), image(productImage) {}
+        : productId(id), name(productName), description(productDescription), price(productPrice), image(productImage), merchantId(-1),
+          detailsLoaded(true) {}
 
     // Getter 和 Setter 方法
     int getProductId() const { return productId; }
@@ -26,18 +39,25 @@ public:
     QString getName() const { return name; }
     void setName(const QString &productName) { name = productName; }
 
-    QString getDescription() const { return description; }
-    void setDescription(const QString &productDescription) { description = productDescription; }
+    QString getDescription() const { loadDetails(); return description; }
+    void setDescription(const QString &productDescription) { loadDetails(); description = productDescription; }
 
     float getPrice() const { return price; }
     void setPrice(float productPrice) { price = productPrice; }
 
-    QString getImage() const { return image; }
-    void setImage(const QString &productImage) { image = productImage; }
+    QString getImage() const { loadDetails(); return image; }
+    void setImage(const QString &productImage) { loadDetails(); image = productImage; }
+
+    int getMerchantId() const { return merchantId; }
+    void setMerchantId(int id) { merchantId = id; }
 
     // 商品的数据库操作
-    void insertProductToDB(QSqlDatabase &db) const;
+    int insertProductToDB(QSqlDatabase &db) const;  // 返回新 productId，失败返回 -1
     static Product getProductFromDB(QSqlDatabase &db, int productId);
+    // 列表查询：只取 productId / name / price / merchantId，描述和图片在首次访问时再查
+    static QList<Product> listProducts(QSqlDatabase &db);
+    // 单个商品的列表行（同上投影），供列表增量刷新；未找到时 productId 为 -1
+    static Product getListRowFromDB(QSqlDatabase &db, int productId);
     static void deleteProductFromDB(QSqlDatabase &db, int productId);
 
     // 显示商品信息
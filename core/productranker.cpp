@@ -0,0 +1,177 @@
+#include "productranker.h"
+#include <QCollator>
+#include <QHash>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QDebug>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// 小于该规模时直接单线程排序
+const size_t PARALLEL_SORT_THRESHOLD = 1 << 15;
+
+// 分块并行排序，再逐层两两归并（同一层的归并也并行执行）
+template <typename It, typename Less>
+void parallelSort(It first, It last, Less less) {
+    size_t n = static_cast<size_t>(last - first);
+    unsigned threadCount = std::thread::hardware_concurrency();
+    if (n < PARALLEL_SORT_THRESHOLD || threadCount < 2) {
+        std::sort(first, last, less);
+        return;
+    }
+
+    size_t chunk = (n + threadCount - 1) / threadCount;
+    std::vector<size_t> bounds;
+    for (size_t begin = 0; begin < n; begin += chunk) {
+        bounds.push_back(begin);
+    }
+    bounds.push_back(n);
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        workers.emplace_back([=]() { std::sort(first + bounds[i], first + bounds[i + 1], less); });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged;
+        workers.clear();
+        size_t i = 0;
+        for (; i + 2 < bounds.size(); i += 2) {
+            merged.push_back(bounds[i]);
+            workers.emplace_back([=]() {
+                std::inplace_merge(first + bounds[i], first + bounds[i + 1], first + bounds[i + 2], less);
+            });
+        }
+        for (; i + 1 < bounds.size(); ++i) {
+            merged.push_back(bounds[i]);
+        }
+        merged.push_back(n);
+        for (std::thread &worker : workers) {
+            worker.join();
+        }
+        bounds.swap(merged);
+    }
+}
+
+} // namespace
+
+bool ProductRanker::load(QSqlDatabase &db) {
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+
+    QHash<int, int> popularity;
+    if (!query.exec("SELECT productId, SUM(quantity) FROM Orders GROUP BY productId")) {
+        qDebug() << "Error loading product popularity:" << query.lastError().text();
+        return false;
+    }
+    while (query.next()) {
+        popularity.insert(query.value(0).toInt(), query.value(1).toInt());
+    }
+
+    if (!query.exec("SELECT productId, name, price FROM Products")) {
+        qDebug() << "Error loading products for ranking:" << query.lastError().text();
+        return false;
+    }
+    std::vector<Entry> loaded;
+    std::vector<QString> names;
+    while (query.next()) {
+        int productId = query.value(0).toInt();
+        loaded.push_back({productId, query.value(2).toFloat(), 0, popularity.value(productId, 0)});
+        names.push_back(query.value(1).toString());
+    }
+
+    // 名称只在加载时按排序规则排一次，之后用整数序号比较
+    QCollator collator;
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    collator.setNumericMode(true);
+    std::vector<QCollatorSortKey> keys;
+    keys.reserve(names.size());
+    for (const QString &name : names) {
+        keys.push_back(collator.sortKey(name));
+    }
+    std::vector<int> order(loaded.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = static_cast<int>(i);
+    }
+    std::sort(order.begin(), order.end(), [&keys](int a, int b) { return keys[a].compare(keys[b]) < 0; });
+    int rank = 0;
+    for (size_t i = 0; i < order.size(); ++i) {
+        if (i > 0 && keys[order[i - 1]].compare(keys[order[i]]) != 0) {
+            ++rank;
+        }
+        loaded[order[i]].nameRank = rank;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    entries.swap(loaded);
+    return true;
+}
+
+int ProductRanker::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return static_cast<int>(entries.size());
+}
+
+std::vector<int> ProductRanker::rank(const std::vector<SortKey> &order) const {
+    return rankPage(order, 0, -1);
+}
+
+std::vector<int> ProductRanker::rankPage(const std::vector<SortKey> &order, int offset, int limit) const {
+    auto less = [&order](const Entry &a, const Entry &b) {
+        for (const SortKey &key : order) {
+            int cmp = 0;
+            switch (key.field) {
+            case RankField::Price:
+                cmp = (a.price > b.price) - (a.price < b.price);
+                break;
+            case RankField::Name:
+                cmp = (a.nameRank > b.nameRank) - (a.nameRank < b.nameRank);
+                break;
+            case RankField::Recency:
+                cmp = (a.productId > b.productId) - (a.productId < b.productId);
+                break;
+            case RankField::Popularity:
+                cmp = (a.popularity > b.popularity) - (a.popularity < b.popularity);
+                break;
+            }
+            if (cmp != 0) {
+                return key.descending ? cmp > 0 : cmp < 0;
+            }
+        }
+        return a.productId < b.productId;  // 保证结果确定
+    };
+
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    std::vector<Entry> work(entries);
+    lock.unlock();
+
+    size_t n = work.size();
+    size_t begin = std::min<size_t>(std::max(offset, 0), n);
+    size_t end = (limit < 0) ? n : std::min(n, begin + static_cast<size_t>(limit));
+
+    if (begin == 0 && end == n) {
+        parallelSort(work.begin(), work.end(), less);
+    } else if (begin < end) {
+        // 先把前 end 个选出来，再在其中定位 begin，最后只对这一页排序
+        if (end < n) {
+            std::nth_element(work.begin(), work.begin() + end, work.end(), less);
+        }
+        if (begin > 0) {
+            std::nth_element(work.begin(), work.begin() + begin, work.begin() + end, less);
+        }
+        std::sort(work.begin() + begin, work.begin() + end, less);
+    }
+
+    std::vector<int> ids;
+    ids.reserve(end > begin ? end - begin : 0);
+    for (size_t i = begin; i < end; ++i) {
+        ids.push_back(work[i].productId);
+    }
+    return ids;
+}
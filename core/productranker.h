@@ -0,0 +1,48 @@
+#ifndef PRODUCTRANKER_H
+#define PRODUCTRANKER_H
+
+#include <QtSql/QSqlDatabase>
+#include <shared_mutex>
+#include <vector>
+
+// 可排序的字段
+enum class RankField {
+    Price,       // 价格
+    Name,        // 名称（按本地化排序规则）
+    Recency,     // 新旧程度（以 productId 近似，越大越新）
+    Popularity   // 销量（Orders 中的 quantity 之和）
+};
+
+// 组合排序中的一个键
+struct SortKey {
+    RankField field;
+    bool descending = false;
+};
+
+// 商品排序服务。
+// load() 把排序用到的字段一次性读成紧凑的键数组（每个商品 16 字节），之后的排序只在内存中进行：
+// rank() 做完整排序（大数组时多线程分块排序再归并），rankPage() 只选出某一页，
+// 用 nth_element 做部分选择，代价为 O(n + k log k)，不必对整个目录排序。
+// 返回值均为按顺序排列的 productId。数据变化后由调用方重新 load()。
+class ProductRanker {
+public:
+    bool load(QSqlDatabase &db);
+
+    std::vector<int> rank(const std::vector<SortKey> &order) const;
+    std::vector<int> rankPage(const std::vector<SortKey> &order, int offset, int limit) const;
+
+    int size() const;
+
+private:
+    struct Entry {
+        int productId;
+        float price;
+        int nameRank;     // 名称在排序规则下的序号，相同名称序号相同
+        int popularity;
+    };
+
+    mutable std::shared_mutex mutex;
+    std::vector<Entry> entries;
+};
+
+#endif // PRODUCTRANKER_H
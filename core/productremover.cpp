@@ -0,0 +1,170 @@
+#include "productremover.h"
+#include "changefeed.h"
+#include "eventjournal.h"
+#include <QStringList>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QDebug>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// SQLite 旧版本单条语句最多 999 个参数
+const int MAX_CHUNK_SIZE = 900;
+
+QString placeholders(int count) {
+    QStringList marks;
+    for (int i = 0; i < count; ++i) {
+        marks << "?";
+    }
+    return marks.join(", ");
+}
+
+} // namespace
+
+int ProductRemover::removeProducts(QSqlDatabase &db, const QList<int> &productIds, int chunkSize) {
+    chunkSize = std::clamp(chunkSize, 1, MAX_CHUNK_SIZE);
+    int removed = 0;
+
+    for (int begin = 0; begin < productIds.size(); begin += chunkSize) {
+        QList<int> chunk = productIds.mid(begin, chunkSize);
+        QString inList = placeholders(chunk.size());
+
+        if (!db.transaction()) {
+            qDebug() << "Error starting bulk removal transaction:" << db.lastError().text();
+            return removed;
+        }
+
+        // 先查出块内确实存在的 ID，只为它们发布事件
+        QSqlQuery select(db);
+        select.prepare("SELECT productId FROM Products WHERE productId IN (" + inList + ")");
+        for (int id : chunk) {
+            select.addBindValue(id);
+        }
+        std::vector<ChangeEvent> events;
+        if (select.exec()) {
+            while (select.next()) {
+                events.push_back({ChangeType::Delete, select.value(0).toInt()});
+            }
+        }
+        select.finish();
+
+        QSqlQuery remove(db);
+        remove.prepare("DELETE FROM Products WHERE productId IN (" + inList + ")");
+        for (int id : chunk) {
+            remove.addBindValue(id);
+        }
+        if (!remove.exec() || !db.commit()) {
+            qDebug() << "Error removing products:" << remove.lastError().text() << db.lastError().text();
+            db.rollback();
+            return removed;
+        }
+
+        removed += remove.numRowsAffected();
+        ChangeFeed::instance().publish(events);
+        if (!events.empty()) {
+            QVariantList removedIds;
+            for (const ChangeEvent &event : events) {
+                removedIds << event.productId;
+            }
+            EventJournal::record(JournalEventType::ProductsRemoved, {QVariant(removedIds)});
+        }
+    }
+
+    qDebug() << "Removed" << removed << "products.";
+    return removed;
+}
+
+int ProductRemover::removeProductsWhere(QSqlDatabase &db, const QString &predicate, const QVariantMap &bindings,
+                                        int chunkSize) {
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare("SELECT productId FROM Products WHERE " + predicate);
+    for (auto it = bindings.constBegin(); it != bindings.constEnd(); ++it) {
+        query.bindValue(it.key(), it.value());
+    }
+    if (!query.exec()) {
+        qDebug() << "Error selecting products to remove:" << query.lastError().text();
+        return 0;
+    }
+
+    QList<int> ids;
+    while (query.next()) {
+        ids.append(query.value(0).toInt());
+    }
+    query.finish();
+    return removeProducts(db, ids, chunkSize);
+}
+
+IncrementalVacuumScheduler::IncrementalVacuumScheduler(QSqlDatabase &db, int pagesPerStep, int idleMs)
+    : db(db), pagesPerStep(pagesPerStep > 0 ? pagesPerStep : DEFAULT_PAGES_PER_STEP), idleMs(idleMs) {
+    clock.start();
+    timer.callOnTimeout([this]() { onTimeout(); });
+    feedToken = ChangeFeed::instance().subscribe([this](const ChangeEvent &) { noteActivity(); });
+}
+
+IncrementalVacuumScheduler::~IncrementalVacuumScheduler() {
+    ChangeFeed::instance().unsubscribe(feedToken);
+}
+
+void IncrementalVacuumScheduler::start(int intervalMs) {
+    timer.start(intervalMs);
+}
+
+void IncrementalVacuumScheduler::stop() {
+    timer.stop();
+}
+
+void IncrementalVacuumScheduler::noteActivity() {
+    lastActivityMs = clock.elapsed();
+}
+
+int IncrementalVacuumScheduler::freePages() const {
+    QSqlQuery query(db);
+    if (query.exec("PRAGMA freelist_count") && query.next()) {
+        return query.value(0).toInt();
+    }
+    return 0;
+}
+
+int IncrementalVacuumScheduler::step() {
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA auto_vacuum") || !query.next() || query.value(0).toInt() != 2) {
+        return 0;  // 非 INCREMENTAL 模式
+    }
+    query.finish();
+
+    int before = freePages();
+    if (before == 0) {
+        return 0;
+    }
+    // incremental_vacuum 每次 sqlite3_step 只回收一页，而 QSqlQuery 不会替无结果列的语句继续 step，
+    // 所以逐页执行，并放在同一个事务里只提交一次
+    // 开不了事务（如其他写者持锁）时跳过本次，避免逐页自动提交、每页一次 fsync
+    if (!db.transaction()) {
+        qDebug() << "Skipping incremental vacuum, cannot start transaction:" << db.lastError().text();
+        return 0;
+    }
+    int target = std::min(before, pagesPerStep);
+    for (int i = 0; i < target; ++i) {
+        if (!query.exec("PRAGMA incremental_vacuum(1)")) {
+            qDebug() << "Error running incremental vacuum:" << query.lastError().text();
+            break;
+        }
+        query.finish();
+    }
+    if (!db.commit()) {
+        qDebug() << "Error committing incremental vacuum:" << db.lastError().text();
+        db.rollback();
+        return 0;
+    }
+    return before - freePages();
+}
+
+void IncrementalVacuumScheduler::onTimeout() {
+    if (clock.elapsed() - lastActivityMs < idleMs) {
+        return;  // 最近有写入，推迟
+    }
+    step();
+}
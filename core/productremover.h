@@ -0,0 +1,66 @@
+#ifndef PRODUCTREMOVER_H
+#define PRODUCTREMOVER_H
+
+#include <QList>
+#include <QVariantMap>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QtSql/QSqlDatabase>
+#include <atomic>
+
+// 批量删除商品。
+// 按 chunkSize 分块，每块一个事务，块与块之间释放写锁，读请求不会被长时间阻塞；
+// 每块提交后通过 ChangeFeed 发布删除事件，缓存与索引据此清理。
+class ProductRemover {
+public:
+    static const int DEFAULT_CHUNK_SIZE = 500;
+
+    // 删除给定的商品，返回实际删除的行数
+    static int removeProducts(QSqlDatabase &db, const QList<int> &productIds, int chunkSize = DEFAULT_CHUNK_SIZE);
+
+    // 删除满足条件的商品，predicate 为 WHERE 子句（仅限受信任的调用方），如 "merchantId = :merchantId"
+    static int removeProductsWhere(QSqlDatabase &db, const QString &predicate, const QVariantMap &bindings,
+                                   int chunkSize = DEFAULT_CHUNK_SIZE);
+};
+
+// 增量 VACUUM 调度器。
+// 需要数据库处于 auto_vacuum = INCREMENTAL 模式（新库由 createTables 设置；旧库需手动执行一次 VACUUM 转换）。
+// 定时检查，只有在最近 idleMs 内没有写入时才执行一步 PRAGMA incremental_vacuum(pagesPerStep)，
+// 以小步释放空闲页，避免整库 VACUUM 长时间阻塞。定时器运行在创建者线程的事件循环中。
+class IncrementalVacuumScheduler {
+public:
+    static const int DEFAULT_PAGES_PER_STEP = 64;
+    static const int DEFAULT_IDLE_MS = 2000;
+
+    explicit IncrementalVacuumScheduler(QSqlDatabase &db, int pagesPerStep = DEFAULT_PAGES_PER_STEP,
+                                        int idleMs = DEFAULT_IDLE_MS);
+    ~IncrementalVacuumScheduler();
+
+    IncrementalVacuumScheduler(const IncrementalVacuumScheduler &) = delete;
+    IncrementalVacuumScheduler &operator=(const IncrementalVacuumScheduler &) = delete;
+
+    void start(int intervalMs = 1000);
+    void stop();
+
+    // 记录一次写入活动（ChangeFeed 事件会自动调用）
+    void noteActivity();
+
+    // 立即执行一步，返回释放的页数
+    int step();
+
+    // 当前空闲页数
+    int freePages() const;
+
+private:
+    void onTimeout();
+
+    QSqlDatabase &db;
+    int pagesPerStep;
+    int idleMs;
+    int feedToken;
+    QTimer timer;
+    QElapsedTimer clock;                    // 单调时钟
+    std::atomic<qint64> lastActivityMs{0};  // 最近一次写入时的 clock 读数，可能由其他线程更新
+};
+
+#endif // PRODUCTREMOVER_H
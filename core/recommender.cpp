@@ -0,0 +1,210 @@
+#include "recommender.h"
+#include "changefeed.h"
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QDebug>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+// 无序商品对 (a < b) 打包成 64 位键
+quint64 pairKey(int a, int b) {
+    return (static_cast<quint64>(static_cast<quint32>(a)) << 32) | static_cast<quint32>(b);
+}
+
+bool byScoreDesc(const Recommendation &lhs, const Recommendation &rhs) {
+    if (lhs.score != rhs.score) {
+        return lhs.score > rhs.score;
+    }
+    return lhs.productId < rhs.productId;
+}
+
+} // namespace
+
+CoPurchaseRecommender::~CoPurchaseRecommender() {
+    detach();
+}
+
+bool CoPurchaseRecommender::build(QSqlDatabase &db) {
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT DISTINCT customerId, productId FROM Orders ORDER BY customerId")) {
+        qDebug() << "Error loading orders for recommendations:" << query.lastError().text();
+        return false;
+    }
+
+    std::unordered_map<int, std::unordered_set<int>> baskets;
+    std::unordered_map<int, std::vector<int>> buyers;
+    std::vector<std::vector<int>> basketList;
+    int currentCustomer = 0;
+    bool first = true;
+    while (query.next()) {
+        int customerId = query.value(0).toInt();
+        int productId = query.value(1).toInt();
+        if (first || customerId != currentCustomer) {
+            basketList.emplace_back();
+            currentCustomer = customerId;
+            first = false;
+        }
+        basketList.back().push_back(productId);
+        baskets[customerId].insert(productId);
+        buyers[productId].push_back(customerId);
+    }
+
+    // 按顾客分片并行计数，每个线程维护自己的局部计数表，最后合并
+    unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+    threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, std::max<size_t>(1, basketList.size())));
+    std::vector<std::unordered_map<quint64, int>> partials(threadCount);
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        workers.emplace_back([&, t]() {
+            std::unordered_map<quint64, int> &local = partials[t];
+            for (size_t i = t; i < basketList.size(); i += threadCount) {
+                const std::vector<int> &basket = basketList[i];
+                for (size_t a = 0; a < basket.size(); ++a) {
+                    for (size_t b = a + 1; b < basket.size(); ++b) {
+                        int lo = std::min(basket[a], basket[b]);
+                        int hi = std::max(basket[a], basket[b]);
+                        ++local[pairKey(lo, hi)];
+                    }
+                }
+            }
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    std::unordered_map<int, Neighbours> counts;
+    for (const auto &partial : partials) {
+        for (const auto &entry : partial) {
+            int lo = static_cast<int>(entry.first >> 32);
+            int hi = static_cast<int>(entry.first & 0xffffffffu);
+            counts[lo][hi] += entry.second;
+            counts[hi][lo] += entry.second;
+        }
+    }
+
+    std::unordered_map<int, std::vector<Recommendation>> top;
+    top.reserve(counts.size());
+    for (const auto &entry : counts) {
+        top.emplace(entry.first, selectTopK(entry.second));
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    basketByCustomer.swap(baskets);
+    buyersByProduct.swap(buyers);
+    coCounts.swap(counts);
+    topNeighbours.swap(top);
+    return true;
+}
+
+void CoPurchaseRecommender::attach() {
+    if (feedToken != 0) {
+        return;
+    }
+    feedToken = ChangeFeed::instance().subscribe([this](const ChangeEvent &event) {
+        if (event.table == ChangeTable::Orders && event.type == ChangeType::Insert) {
+            recordPurchase(event.customerId, event.productId);
+        } else if (event.table == ChangeTable::Products && event.type == ChangeType::Delete) {
+            removeProduct(event.productId);
+        }
+    });
+}
+
+void CoPurchaseRecommender::detach() {
+    if (feedToken != 0) {
+        ChangeFeed::instance().unsubscribe(feedToken);
+        feedToken = 0;
+    }
+}
+
+void CoPurchaseRecommender::recordPurchase(int customerId, int productId) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::unordered_set<int> &basket = basketByCustomer[customerId];
+    if (!basket.insert(productId).second) {
+        return;  // 同一顾客重复购买不改变共购关系
+    }
+    buyersByProduct[productId].push_back(customerId);
+    for (int other : basket) {
+        if (other == productId) {
+            continue;
+        }
+        int score = ++coCounts[productId][other];
+        ++coCounts[other][productId];
+        bumpNeighbour(other, productId, score);
+    }
+    auto it = coCounts.find(productId);
+    if (it != coCounts.end()) {
+        topNeighbours[productId] = selectTopK(it->second);
+    }
+}
+
+void CoPurchaseRecommender::removeProduct(int productId) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto it = coCounts.find(productId);
+    if (it != coCounts.end()) {
+        for (const auto &entry : it->second) {
+            Neighbours &neighbours = coCounts[entry.first];
+            neighbours.erase(productId);
+            topNeighbours[entry.first] = selectTopK(neighbours);
+        }
+        coCounts.erase(it);
+    }
+    topNeighbours.erase(productId);
+    // 只清理买过该商品的顾客，代价与买家数成正比而不是与顾客总数成正比
+    auto buyers = buyersByProduct.find(productId);
+    if (buyers != buyersByProduct.end()) {
+        for (int customerId : buyers->second) {
+            auto basket = basketByCustomer.find(customerId);
+            if (basket != basketByCustomer.end()) {
+                basket->second.erase(productId);
+            }
+        }
+        buyersByProduct.erase(buyers);
+    }
+}
+
+std::vector<Recommendation> CoPurchaseRecommender::recommendationsFor(int productId) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto it = topNeighbours.find(productId);
+    if (it == topNeighbours.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+std::vector<Recommendation> CoPurchaseRecommender::selectTopK(const Neighbours &neighbours) const {
+    std::vector<Recommendation> all;
+    all.reserve(neighbours.size());
+    for (const auto &entry : neighbours) {
+        all.push_back({entry.first, entry.second});
+    }
+    if (static_cast<int>(all.size()) > topK) {
+        std::partial_sort(all.begin(), all.begin() + topK, all.end(), byScoreDesc);
+        all.resize(topK);
+    } else {
+        std::sort(all.begin(), all.end(), byScoreDesc);
+    }
+    return all;
+}
+
+// 分数只增不减，因此只需把新分数插入已有 top-K 列表并截断
+void CoPurchaseRecommender::bumpNeighbour(int productId, int neighbourId, int score) {
+    std::vector<Recommendation> &list = topNeighbours[productId];
+    auto it = std::find_if(list.begin(), list.end(),
+                           [neighbourId](const Recommendation &r) { return r.productId == neighbourId; });
+    if (it != list.end()) {
+        it->score = score;
+    } else if (static_cast<int>(list.size()) < topK || byScoreDesc({neighbourId, score}, list.back())) {
+        list.push_back({neighbourId, score});
+    } else {
+        return;
+    }
+    std::sort(list.begin(), list.end(), byScoreDesc);
+    if (static_cast<int>(list.size()) > topK) {
+        list.resize(topK);
+    }
+}
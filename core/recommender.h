@@ -0,0 +1,59 @@
+#ifndef RECOMMENDER_H
+#define RECOMMENDER_H
+
+#include <QtSql/QSqlDatabase>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 一条“买了又买”推荐：相邻商品及共同购买的顾客数
+struct Recommendation {
+    int productId;
+    int score;
+};
+
+// 基于 Orders 的共同购买推荐。
+// build() 从 Orders 一次性构建稀疏共购计数矩阵（多线程并行计数），并归约为每个商品的 top-K 邻居；
+// attach() 后订阅 ChangeFeed，结账写入订单时增量更新。
+// recommendationsFor() 只查内存哈希表，不产生任何 SQL。
+class CoPurchaseRecommender {
+public:
+    static const int DEFAULT_TOP_K = 10;
+
+    explicit CoPurchaseRecommender(int topK = DEFAULT_TOP_K) : topK(topK > 0 ? topK : DEFAULT_TOP_K) {}
+    ~CoPurchaseRecommender();
+
+    CoPurchaseRecommender(const CoPurchaseRecommender &) = delete;
+    CoPurchaseRecommender &operator=(const CoPurchaseRecommender &) = delete;
+
+    // 从 Orders 全量重建
+    bool build(QSqlDatabase &db);
+
+    // 订阅 ChangeFeed：新订单增量计数，商品删除时移除
+    void attach();
+    void detach();
+
+    // 增量更新入口
+    void recordPurchase(int customerId, int productId);
+    void removeProduct(int productId);
+
+    // 按得分降序返回 productId 的推荐（最多 topK 条）
+    std::vector<Recommendation> recommendationsFor(int productId) const;
+
+private:
+    using Neighbours = std::unordered_map<int, int>;  // productId -> 共购次数
+
+    std::vector<Recommendation> selectTopK(const Neighbours &neighbours) const;
+    void bumpNeighbour(int productId, int neighbourId, int score);
+
+    int topK;
+    int feedToken = 0;
+    mutable std::shared_mutex mutex;
+    std::unordered_map<int, std::unordered_set<int>> basketByCustomer;  // 顾客买过的商品
+    std::unordered_map<int, std::vector<int>> buyersByProduct;           // 反向索引：买过该商品的顾客
+    std::unordered_map<int, Neighbours> coCounts;                        // 稀疏对称共购矩阵
+    std::unordered_map<int, std::vector<Recommendation>> topNeighbours;  // 归约后的 top-K
+};
+
+#endif // RECOMMENDER_H
@@ -0,0 +1,350 @@
+#include "repricer.h"
+#include "changefeed.h"
+#include "eventjournal.h"
+#include "hotqueries.h"
+#include <QUuid>
+#include <QVariantList>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QDebug>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+QString priceExpression(PriceAdjustment::Kind kind) {
+    if (kind == PriceAdjustment::Percent) {
+        return "MAX(0, ROUND(price * (100.0 + :amount) / 100.0, 2))";
+    }
+    return "MAX(0, ROUND(price + :amount, 2))";
+}
+
+QString kindName(PriceAdjustment::Kind kind) {
+    return kind == PriceAdjustment::Percent ? "percent" : "absolute";
+}
+
+QString toStoredTime(const QDateTime &time) {
+    return time.toUTC().toString(Qt::ISODate);
+}
+
+QList<int> selectIds(QSqlDatabase &db, const QString &sql, const QString &now) {
+    QList<int> ids;
+    QSqlQuery query(db);
+    query.prepare(sql);
+    query.bindValue(":now", now);
+    if (!query.exec()) {
+        qDebug() << "Error selecting price campaigns:" << query.lastError().text();
+        return ids;
+    }
+    while (query.next()) {
+        ids.append(query.value(0).toInt());
+    }
+    return ids;
+}
+
+} // namespace
+
+int Repricer::apply(QSqlDatabase &db, const ProductSelection &selection, const PriceAdjustment &adjustment) {
+    if (!db.transaction()) {
+        qDebug() << "Error starting repricing transaction:" << db.lastError().text();
+        return -1;
+    }
+
+    QSqlQuery query(db);
+    QString idQuery;
+    if (!selection.productIds.isEmpty()) {
+        // 指定商品先写入临时表，再用一条 UPDATE 关联，商品数量不受参数个数限制
+        query.exec("CREATE TEMP TABLE IF NOT EXISTS RepriceSelection (productId INTEGER PRIMARY KEY)");
+        query.exec("DELETE FROM temp.RepriceSelection");
+        query.prepare("INSERT OR IGNORE INTO temp.RepriceSelection (productId) VALUES (?)");
+        QVariantList ids;
+        for (int id : selection.productIds) {
+            ids << id;
+        }
+        query.addBindValue(ids);
+        if (!query.execBatch()) {
+            qDebug() << "Error preparing repricing selection:" << query.lastError().text();
+            db.rollback();
+            return -1;
+        }
+        idQuery = "SELECT productId FROM temp.RepriceSelection";
+    } else if (selection.merchantId > 0) {
+        idQuery = QString("SELECT productId FROM Products WHERE merchantId = %1").arg(selection.merchantId);
+    } else {
+        idQuery = "SELECT productId FROM Products";
+    }
+
+    query.prepare("UPDATE Products SET price = " + priceExpression(adjustment.kind) +
+                  " WHERE productId IN (" + idQuery + ")");
+    query.bindValue(":amount", adjustment.amount);
+    if (!query.exec()) {
+        qDebug() << "Error repricing products:" << query.lastError().text();
+        db.rollback();
+        return -1;
+    }
+    int affected = query.numRowsAffected();
+    query.finish();
+    if (!db.commit()) {
+        qDebug() << "Error committing repricing:" << db.lastError().text();
+        db.rollback();
+        return -1;
+    }
+
+    publishUpdates(db, "SELECT productId FROM Products WHERE productId IN (" + idQuery + ")", -1, "reprice");
+    qDebug() << "Repriced" << affected << "products.";
+    return affected;
+}
+
+int Repricer::scheduleCampaign(QSqlDatabase &db, const QString &name, const ProductSelection &selection,
+                               const PriceAdjustment &adjustment, const QDateTime &startsAt, const QDateTime &endsAt) {
+    if (!db.transaction()) {
+        qDebug() << "Error starting campaign transaction:" << db.lastError().text();
+        return -1;
+    }
+
+    QString scope = !selection.productIds.isEmpty() ? "products" : (selection.merchantId > 0 ? "merchant" : "all");
+    QSqlQuery query(db);
+    query.prepare("INSERT INTO PriceCampaigns (name, kind, amount, scope, merchantId, startsAt, endsAt, status) "
+                  "VALUES (:name, :kind, :amount, :scope, :merchantId, :startsAt, :endsAt, 'scheduled')");
+    query.bindValue(":name", name);
+    query.bindValue(":kind", kindName(adjustment.kind));
+    query.bindValue(":amount", adjustment.amount);
+    query.bindValue(":scope", scope);
+    query.bindValue(":merchantId", selection.merchantId > 0 ? QVariant(selection.merchantId) : QVariant());
+    query.bindValue(":startsAt", toStoredTime(startsAt));
+    query.bindValue(":endsAt", toStoredTime(endsAt));
+    if (!query.exec()) {
+        qDebug() << "Error scheduling campaign:" << query.lastError().text();
+        db.rollback();
+        return -1;
+    }
+    int campaignId = query.lastInsertId().toInt();
+
+    // 指定商品的活动在登记时就记下成员，原价在开始时才记录
+    if (scope == "products") {
+        query.prepare("INSERT OR IGNORE INTO CampaignPrices (campaignId, productId) VALUES (?, ?)");
+        QVariantList campaignIds;
+        QVariantList productIds;
+        for (int id : selection.productIds) {
+            campaignIds << campaignId;
+            productIds << id;
+        }
+        query.addBindValue(campaignIds);
+        query.addBindValue(productIds);
+        if (!query.execBatch()) {
+            qDebug() << "Error scheduling campaign products:" << query.lastError().text();
+            db.rollback();
+            return -1;
+        }
+    }
+
+    if (!db.commit()) {
+        qDebug() << "Error committing campaign:" << db.lastError().text();
+        db.rollback();
+        return -1;
+    }
+    return campaignId;
+}
+
+int Repricer::runDueCampaigns(QSqlDatabase &db, const QDateTime &now) {
+    QString nowText = toStoredTime(now);
+    int changed = 0;
+
+    // 整个活动期都已错过的直接结束，不调价
+    for (int id : selectIds(db, "SELECT campaignId FROM PriceCampaigns "
+                                "WHERE status = 'scheduled' AND endsAt <= :now", nowText)) {
+        changed += endCampaign(db, id, false) ? 1 : 0;
+    }
+    // 先结束到期的活动，释放其商品，再开始新活动
+    for (int id : selectIds(db, "SELECT campaignId FROM PriceCampaigns "
+                                "WHERE status = 'active' AND endsAt <= :now ORDER BY campaignId DESC", nowText)) {
+        changed += endCampaign(db, id, true) ? 1 : 0;
+    }
+    for (int id : selectIds(db, "SELECT campaignId FROM PriceCampaigns "
+                                "WHERE status = 'scheduled' AND startsAt <= :now ORDER BY campaignId", nowText)) {
+        changed += activateCampaign(db, id) ? 1 : 0;
+    }
+    return changed;
+}
+
+bool Repricer::activateCampaign(QSqlDatabase &db, int campaignId) {
+    QSqlQuery query(db);
+    query.prepare("SELECT kind, amount, scope, merchantId FROM PriceCampaigns WHERE campaignId = :campaignId");
+    query.bindValue(":campaignId", campaignId);
+    if (!query.exec() || !query.next()) {
+        qDebug() << "Error loading campaign" << campaignId << ":" << query.lastError().text();
+        return false;
+    }
+    PriceAdjustment::Kind kind = query.value(0).toString() == "percent" ? PriceAdjustment::Percent
+                                                                         : PriceAdjustment::Absolute;
+    double amount = query.value(1).toDouble();
+    QString scope = query.value(2).toString();
+    QVariant merchantId = query.value(3);
+    query.finish();
+
+    if (!db.transaction()) {
+        qDebug() << "Error starting campaign transaction:" << db.lastError().text();
+        return false;
+    }
+
+    bool ok = true;
+    if (scope != "products") {
+        query.prepare(QString("INSERT OR IGNORE INTO CampaignPrices (campaignId, productId) "
+                              "SELECT :campaignId, productId FROM Products%1")
+                          .arg(scope == "merchant" ? " WHERE merchantId = :merchantId" : ""));
+        query.bindValue(":campaignId", campaignId);
+        if (scope == "merchant") {
+            query.bindValue(":merchantId", merchantId);
+        }
+        ok = query.exec();
+    }
+
+    // 去掉已在其他进行中活动里的商品（活动不叠加，否则先结束的活动无法恢复原价），
+    // 记录原价，去掉已不存在的商品，再一次性调价并记录活动价
+    const QStringList steps = {
+        "DELETE FROM CampaignPrices WHERE campaignId = :campaignId AND productId IN "
+        "(SELECT cp.productId FROM CampaignPrices cp JOIN PriceCampaigns c ON c.campaignId = cp.campaignId "
+        " WHERE c.status = 'active')",
+        "UPDATE CampaignPrices SET originalPrice = "
+        "(SELECT price FROM Products p WHERE p.productId = CampaignPrices.productId) WHERE campaignId = :campaignId",
+        "DELETE FROM CampaignPrices WHERE campaignId = :campaignId AND originalPrice IS NULL",
+        "UPDATE Products SET price = " + priceExpression(kind) +
+        " WHERE productId IN (SELECT productId FROM CampaignPrices WHERE campaignId = :campaignId)",
+        "UPDATE CampaignPrices SET campaignPrice = "
+        "(SELECT price FROM Products p WHERE p.productId = CampaignPrices.productId) WHERE campaignId = :campaignId",
+        "UPDATE PriceCampaigns SET status = 'active' WHERE campaignId = :campaignId"
+    };
+    for (const QString &sql : steps) {
+        if (!ok) {
+            break;
+        }
+        query.prepare(sql);
+        query.bindValue(":campaignId", campaignId);
+        if (sql.contains(":amount")) {
+            query.bindValue(":amount", amount);
+        }
+        ok = query.exec();
+    }
+
+    if (!ok || !db.commit()) {
+        qDebug() << "Error activating campaign" << campaignId << ":" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    publishUpdates(db, "SELECT productId FROM CampaignPrices WHERE campaignId = :campaignId", campaignId,
+                   "campaign-start");
+    qDebug() << "Price campaign" << campaignId << "started.";
+    return true;
+}
+
+bool Repricer::endCampaign(QSqlDatabase &db, int campaignId, bool revert) {
+    if (!db.transaction()) {
+        qDebug() << "Error starting campaign transaction:" << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery query(db);
+    bool ok = true;
+    if (revert) {
+        // 只恢复价格仍是活动价的商品
+        query.prepare(HotQueries::CAMPAIGN_REVERT);
+        query.addBindValue(campaignId);
+        query.addBindValue(campaignId);
+        query.addBindValue(campaignId);
+        ok = query.exec();
+    }
+    if (ok) {
+        query.prepare("UPDATE PriceCampaigns SET status = 'ended' WHERE campaignId = :campaignId");
+        query.bindValue(":campaignId", campaignId);
+        ok = query.exec();
+    }
+
+    if (!ok || !db.commit()) {
+        qDebug() << "Error ending campaign" << campaignId << ":" << query.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    if (revert) {
+        publishUpdates(db, "SELECT productId FROM CampaignPrices WHERE campaignId = :campaignId", campaignId,
+                       "campaign-end");
+    }
+    qDebug() << "Price campaign" << campaignId << "ended.";
+    return true;
+}
+
+void Repricer::publishUpdates(QSqlDatabase &db, const QString &idQuery, int campaignId, const QString &reason) {
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    query.prepare(idQuery);
+    if (campaignId > 0) {
+        query.bindValue(":campaignId", campaignId);
+    }
+    if (!query.exec()) {
+        qDebug() << "Error collecting repriced products:" << query.lastError().text();
+        return;
+    }
+    std::vector<ChangeEvent> events;
+    QVariantList changedIds;
+    while (query.next()) {
+        events.push_back({ChangeType::Update, query.value(0).toInt()});
+        changedIds << events.back().productId;
+    }
+    query.finish();
+    EventJournal::record(JournalEventType::PricesChanged, {reason, campaignId, QVariant(changedIds)});
+
+    // 全场活动等大批量调价只通知一次，避免订阅者逐个商品回库查询
+    if (static_cast<int>(events.size()) > BULK_UPDATE_THRESHOLD) {
+        ChangeFeed::instance().publish({ChangeType::Reload, -1});
+    } else {
+        ChangeFeed::instance().publish(events);
+    }
+}
+
+CampaignScheduler::CampaignScheduler(const QString &databasePath) : databasePath(databasePath) {}
+
+CampaignScheduler::~CampaignScheduler() {
+    stop();
+}
+
+void CampaignScheduler::start(int intervalMs) {
+    stop();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = false;
+    }
+    worker = std::thread([this, intervalMs]() {
+        // 连接只在本线程内创建和使用
+        const QString connection = "campaigns_" + QUuid::createUuid().toString(QUuid::WithoutBraces);
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+            db.setDatabaseName(databasePath);
+            db.setConnectOptions("QSQLITE_BUSY_TIMEOUT=5000");
+            if (!db.open()) {
+                qDebug() << "Cannot open database for price campaigns:" << db.lastError().text();
+            } else {
+                std::unique_lock<std::mutex> lock(stateMutex);
+                do {
+                    lock.unlock();
+                    Repricer::runDueCampaigns(db);
+                    lock.lock();
+                } while (!wakeUp.wait_for(lock, std::chrono::milliseconds(intervalMs), [this]() { return stopping; }));
+                lock.unlock();
+                db.close();
+            }
+        }
+        QSqlDatabase::removeDatabase(connection);
+    });
+}
+
+void CampaignScheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef REPRICER_H
+#define REPRICER_H
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QtSql/QSqlDatabase>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// 调价方式
+struct PriceAdjustment {
+    enum Kind {
+        Percent,    // 按百分比：amount = -10 表示打九折
+        Absolute    // 按金额：amount = -5 表示每件减 5
+    };
+    Kind kind;
+    double amount;
+};
+
+// 调价的商品范围：指定 productIds，或某商家的全部商品，或全部商品
+struct ProductSelection {
+    QList<int> productIds;  // 非空时只调这些商品
+    int merchantId = -1;    // productIds 为空且 > 0 时，调该商家的全部商品；否则调全部商品
+};
+
+// 批量调价与定时价格活动。
+// 调价用一条集合式 UPDATE 在一个事务内完成（价格不低于 0，保留两位小数），
+// 提交后通过 ChangeFeed 批量发布 Update 事件，缓存和索引一次性刷新。
+// 活动在 PriceCampaigns 中登记，runDueCampaigns() 到开始时间时调价并在 CampaignPrices 记下原价，
+// 到结束时间时恢复原价；若活动期间价格又被其他操作改动，则该商品不恢复，以免覆盖新价格。
+// 活动不叠加：开始时已在其他进行中活动里的商品不参加本活动。
+class Repricer {
+public:
+    // 涉及商品超过此数量时只发布一条 Reload 事件，而不是逐个商品发布 Update
+    static const int BULK_UPDATE_THRESHOLD = 64;
+
+    // 立即调价，返回调整的商品数（失败返回 -1）
+    static int apply(QSqlDatabase &db, const ProductSelection &selection, const PriceAdjustment &adjustment);
+
+    // 登记一个价格活动，返回 campaignId（失败返回 -1）
+    static int scheduleCampaign(QSqlDatabase &db, const QString &name, const ProductSelection &selection,
+                                const PriceAdjustment &adjustment, const QDateTime &startsAt, const QDateTime &endsAt);
+
+    // 开始到期的活动、结束过期的活动，返回状态发生变化的活动数；由调用方定时调用
+    static int runDueCampaigns(QSqlDatabase &db, const QDateTime &now = QDateTime::currentDateTimeUtc());
+
+private:
+    static bool activateCampaign(QSqlDatabase &db, int campaignId);
+    static bool endCampaign(QSqlDatabase &db, int campaignId, bool revert);
+    // 发布变更事件并写入事件日志
+    static void publishUpdates(QSqlDatabase &db, const QString &idQuery, int campaignId, const QString &reason);
+};
+
+// 在后台线程上定时执行 Repricer::runDueCampaigns()。
+// 线程使用自己的数据库连接（与 BackupService 相同），大活动的批量 UPDATE 不阻塞 GUI 线程；
+// ChangeFeed 事件因此在该线程上发布，订阅者需自行切回所在线程。
+class CampaignScheduler {
+public:
+    explicit CampaignScheduler(const QString &databasePath);
+    ~CampaignScheduler();
+
+    CampaignScheduler(const CampaignScheduler &) = delete;
+    CampaignScheduler &operator=(const CampaignScheduler &) = delete;
+
+    // 启动后立即检查一次，之后每 intervalMs 检查一次
+    void start(int intervalMs);
+    void stop();
+
+private:
+    QString databasePath;
+    std::mutex stateMutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+    std::thread worker;
+};
+
+#endif // REPRICER_H
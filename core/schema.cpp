@@ -0,0 +1,146 @@
+#include "schema.h"
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QDebug>
+
+// 旧库兼容：若表中缺少某列则补上
+static void ensureColumn(QSqlDatabase &db, const QString &table, const QString &column, const QString &definition) {
+    QSqlQuery query(db);
+    query.exec(QString("PRAGMA table_info(%1)").arg(table));
+    while (query.next()) {
+        if (query.value(1).toString() == column) { // column name is at index 1
+            return;
+        }
+    }
+    qDebug() << "Adding missing" << column << "column to" << table << "table.";
+    if (!query.exec(QString("ALTER TABLE %1 ADD COLUMN %2 %3").arg(table, column, definition))) {
+        qDebug() << "Error adding" << column << "column:" << query.lastError().text();
+    } else {
+        qDebug() << "Added" << column << "column to" << table << "table.";
+    }
+}
+
+void createTables(QSqlDatabase &db) {
+    // 检查数据库是否打开
+    if (!db.isOpen()) {
+        qDebug() << "Database is not open!";
+        return;
+    }
+
+    QSqlQuery query(db);
+
+    // 删除后的空闲页交给 IncrementalVacuumScheduler 逐步回收；只对尚未建表的新库生效
+    query.exec("PRAGMA auto_vacuum = INCREMENTAL");
+
+    // WAL：读者（包括在线备份）不阻塞写者
+    query.exec("PRAGMA journal_mode = WAL");
+
+    // 创建 Users 表
+    query.exec("CREATE TABLE IF NOT EXISTS Users ("
+               "userId INTEGER PRIMARY KEY AUTOINCREMENT, "
+               "username TEXT NOT NULL, "
+               "password TEXT NOT NULL, "
+               "email TEXT NOT NULL, "
+               "role TEXT NOT NULL)");
+
+    if (query.lastError().isValid()) {
+        qDebug() << "Error creating Users table:" << query.lastError().text();
+    } else {
+        qDebug() << "Users table created successfully.";
+    }
+
+    // Ensure backward compatibility: add `salt` column if it doesn't exist (for older DBs)
+    ensureColumn(db, "Users", "salt", "TEXT");
+    // 每个用户的哈希参数（旧记录为 NULL，按 User::DEFAULT_PBKDF2_ITERATIONS 校验）
+    ensureColumn(db, "Users", "hashAlgorithm", "TEXT");
+    ensureColumn(db, "Users", "iterations", "INTEGER");
+
+    // 登录按用户名查找；唯一索引同时保证并发注册/导入不会写入重复用户名。
+    // 旧库中的同名普通索引在唯一索引建成后删除；库中已有重复用户名时保留旧索引并报错
+    if (!query.exec("CREATE UNIQUE INDEX IF NOT EXISTS idx_users_username_unique ON Users(username)")) {
+        qDebug() << "Error creating Users username unique index:" << query.lastError().text();
+        query.exec("CREATE INDEX IF NOT EXISTS idx_users_username ON Users(username)");
+    } else {
+        query.exec("DROP INDEX IF EXISTS idx_users_username");
+    }
+
+    // 创建 Products 表
+    query.exec("CREATE TABLE IF NOT EXISTS Products ("
+               "productId INTEGER PRIMARY KEY AUTOINCREMENT, "
+               "name TEXT NOT NULL, "
+               "description TEXT, "
+               "price REAL NOT NULL, "
+               "image TEXT, "
+               "merchantId INTEGER REFERENCES Users(userId), "
+               "descriptionZ BLOB)");
+
+    if (query.lastError().isValid()) {
+        qDebug() << "Error creating Products table:" << query.lastError().text();
+    } else {
+        qDebug() << "Products table created successfully.";
+    }
+
+    // 商品归属商家（旧库中为 NULL）
+    ensureColumn(db, "Products", "merchantId", "INTEGER REFERENCES Users(userId)");
+    // 压缩存储的长描述（与 description 二选一）
+    ensureColumn(db, "Products", "descriptionZ", "BLOB");
+
+    // 按商家查询（导出、批量下架、分片）
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_products_merchant ON Products(merchantId)")) {
+        qDebug() << "Error creating Products merchant index:" << query.lastError().text();
+    }
+
+    // 创建 Orders 表
+    query.exec("CREATE TABLE IF NOT EXISTS Orders ("
+               "orderId INTEGER PRIMARY KEY AUTOINCREMENT, "
+               "customerId INTEGER NOT NULL, "
+               "productId INTEGER NOT NULL, "
+               "quantity INTEGER NOT NULL, "
+               "orderDate TEXT NOT NULL, "
+               "merchantId INTEGER, "
+               "unitPrice REAL, "
+               "FOREIGN KEY (customerId) REFERENCES Users(userId), "
+               "FOREIGN KEY (productId) REFERENCES Products(productId))");
+
+    if (query.lastError().isValid()) {
+        qDebug() << "Error creating Orders table:" << query.lastError().text();
+    } else {
+        qDebug() << "Orders table created successfully.";
+    }
+
+    // 下单时的商家与成交单价，商品之后改价或下架不影响历史订单（旧订单为 NULL）
+    ensureColumn(db, "Orders", "merchantId", "INTEGER");
+    ensureColumn(db, "Orders", "unitPrice", "REAL");
+
+    // 顾客订单历史：按 (customerId, orderDate, orderId) 有序，并带上 productId/quantity 成为覆盖索引
+    if (!query.exec("CREATE INDEX IF NOT EXISTS idx_orders_customer_date "
+                    "ON Orders(customerId, orderDate, orderId, productId, quantity)")) {
+        qDebug() << "Error creating Orders history index:" << query.lastError().text();
+    }
+
+    // 价格活动及其涉及商品的原价/活动价
+    query.exec("CREATE TABLE IF NOT EXISTS PriceCampaigns ("
+               "campaignId INTEGER PRIMARY KEY AUTOINCREMENT, "
+               "name TEXT NOT NULL, "
+               "kind TEXT NOT NULL, "
+               "amount REAL NOT NULL, "
+               "scope TEXT NOT NULL, "
+               "merchantId INTEGER, "
+               "startsAt TEXT NOT NULL, "
+               "endsAt TEXT NOT NULL, "
+               "status TEXT NOT NULL)");
+    if (query.lastError().isValid()) {
+        qDebug() << "Error creating PriceCampaigns table:" << query.lastError().text();
+    }
+    query.exec("CREATE INDEX IF NOT EXISTS idx_campaigns_status ON PriceCampaigns(status, startsAt)");
+
+    query.exec("CREATE TABLE IF NOT EXISTS CampaignPrices ("
+               "campaignId INTEGER NOT NULL REFERENCES PriceCampaigns(campaignId), "
+               "productId INTEGER NOT NULL, "
+               "originalPrice REAL, "
+               "campaignPrice REAL, "
+               "PRIMARY KEY (campaignId, productId))");
+    if (query.lastError().isValid()) {
+        qDebug() << "Error creating CampaignPrices table:" << query.lastError().text();
+    }
+}
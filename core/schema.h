@@ -0,0 +1,9 @@
+#ifndef SCHEMA_H
+#define SCHEMA_H
+
+#include <QtSql/QSqlDatabase>
+
+// 创建/升级数据库表结构（Users / Products / Orders / 价格活动）
+void createTables(QSqlDatabase &db);
+
+#endif // SCHEMA_H
@@ -0,0 +1,122 @@
+#include "shardrouter.h"
+#include "schema.h"
+#include <QDir>
+#include <QtSql/QSqlQuery>
+#include <QtSql/QSqlError>
+#include <QDebug>
+#include <algorithm>
+#include <climits>
+
+ShardRouter::ShardRouter(const QString &directory, int shardCount, const QString &baseName)
+    : directory(directory), baseName(baseName), count(std::clamp(shardCount, 1, MAX_SHARDS)) {
+    stride = INT_MAX / count;
+}
+
+ShardRouter::~ShardRouter() {
+    close();
+}
+
+QString ShardRouter::shardPath(int index) const {
+    return QDir(directory).filePath(QString("%1.shard%2.db").arg(baseName).arg(index));
+}
+
+QString ShardRouter::connectionName(int index) const {
+    return QString("%1_shard%2").arg(baseName).arg(index);
+}
+
+// 固定哈希（不能用带进程随机种子的 qHash），保证重启后同一商家仍落在同一分片。
+// 取模前用 murmur3 的 fmix32 充分混合所有位；单纯乘法哈希的低位对 2 的幂分片数等于 id % count，
+// 同奇偶的商家只会落在一半分片上。
+int ShardRouter::shardForMerchant(int merchantId) const {
+    quint32 h = static_cast<quint32>(merchantId);
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return static_cast<int>(h % static_cast<quint32>(count));
+}
+
+int ShardRouter::shardForProduct(int productId) const {
+    if (productId <= 0) {
+        return 0;
+    }
+    return std::min((productId - 1) / stride, count - 1);
+}
+
+bool ShardRouter::open() {
+    for (int i = 0; i < count; ++i) {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName(i));
+        db.setDatabaseName(shardPath(i));
+        if (!db.open()) {
+            qDebug() << "Error opening shard" << i << ":" << db.lastError().text();
+            return false;
+        }
+        createTables(db);
+        if (!reserveIdRange(db, i)) {
+            return false;
+        }
+        shards.push_back(db);
+    }
+    return true;
+}
+
+void ShardRouter::close() {
+    for (int i = 0; i < static_cast<int>(shards.size()); ++i) {
+        shards[i].close();
+    }
+    shards.clear();
+    for (int i = 0; i < count; ++i) {
+        QSqlDatabase::removeDatabase(connectionName(i));
+    }
+}
+
+// 把分片的 AUTOINCREMENT 计数器推进到本分片的 ID 区间起点
+bool ShardRouter::reserveIdRange(QSqlDatabase &db, int index) {
+    qint64 base = static_cast<qint64>(index) * stride;
+    if (base == 0) {
+        return true;
+    }
+    for (const QString &table : {QString("Products"), QString("Orders")}) {
+        QSqlQuery query(db);
+        query.prepare("SELECT seq FROM sqlite_sequence WHERE name = :name");
+        query.bindValue(":name", table);
+        if (!query.exec()) {
+            qDebug() << "Error reading id sequence:" << query.lastError().text();
+            return false;
+        }
+        bool exists = query.next();
+        if (exists && query.value(0).toLongLong() >= base) {
+            continue;
+        }
+        query.finish();
+        query.prepare(exists ? "UPDATE sqlite_sequence SET seq = :seq WHERE name = :name"
+                             : "INSERT INTO sqlite_sequence (name, seq) VALUES (:name, :seq)");
+        query.bindValue(":name", table);
+        query.bindValue(":seq", base);
+        if (!query.exec()) {
+            qDebug() << "Error reserving id range for shard" << index << ":" << query.lastError().text();
+            return false;
+        }
+    }
+    return true;
+}
+
+QList<Product> ShardRouter::listCatalog() {
+    // 分片的 ID 区间按分片序号递增，各分片内排好序后顺序拼接即全局有序
+    QList<Product> catalog;
+    for (QSqlDatabase &db : shards) {
+        QList<Product> part = Product::listProducts(db);
+        std::sort(part.begin(), part.end(),
+                  [](const Product &a, const Product &b) { return a.getProductId() < b.getProductId(); });
+        catalog.append(part);
+    }
+    return catalog;
+}
+
+Product ShardRouter::getProduct(int productId) {
+    if (shards.empty()) {
+        return Product(-1, "", "", 0.0, "");
+    }
+    return Product::getProductFromDB(databaseForProduct(productId), productId);
+}
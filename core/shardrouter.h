@@ -0,0 +1,59 @@
+#ifndef SHARDROUTER_H
+#define SHARDROUTER_H
+
+#include "product.h"
+#include <QList>
+#include <QString>
+#include <QtSql/QSqlDatabase>
+#include <vector>
+
+// 按商家分片的商品/订单存储。
+// 每个商家按 merchantId 的固定哈希落在 N 个数据库文件之一（<dir>/<baseName>.shard<i>.db），
+// 不同分片的写入互不争用同一把 SQLite 写锁。各分片的 AUTOINCREMENT 起点错开，
+// 分片 i 的 productId / orderId 落在 [i * stride + 1, (i + 1) * stride]，因此 ID 全局唯一，
+// 并且仅凭 productId 即可定位分片。用户表仍在主库中。
+// Merchant/Customer 的 ShardRouter 重载把上架、下架、下单路由到对应分片。
+// 尚未接入 MainWindow：补全索引、推荐、定时活动、空间回收、备份、导出和订单历史都还只读写主库，
+// 这些模块按分片实例化或扇出之前不提供分片开关。
+// 分片数一经使用不可更改（需要重新分片）。连接属于创建 router 的线程；
+// 其他线程应通过 shardPath() 自行打开连接。
+class ShardRouter {
+public:
+    static const int MAX_SHARDS = 10;
+
+    ShardRouter(const QString &directory, int shardCount, const QString &baseName = "ShopLink");
+    ~ShardRouter();
+
+    ShardRouter(const ShardRouter &) = delete;
+    ShardRouter &operator=(const ShardRouter &) = delete;
+
+    // 打开（必要时创建）所有分片
+    bool open();
+    void close();
+
+    int shardCount() const { return count; }
+    QString shardPath(int index) const;
+
+    int shardForMerchant(int merchantId) const;
+    int shardForProduct(int productId) const;
+
+    QSqlDatabase &shard(int index) { return shards[index]; }
+    QSqlDatabase &databaseForMerchant(int merchantId) { return shards[shardForMerchant(merchantId)]; }
+    QSqlDatabase &databaseForProduct(int productId) { return shards[shardForProduct(productId)]; }
+
+    // 跨分片读取：逐个分片查询后合并，结果按 productId 升序
+    QList<Product> listCatalog();
+    Product getProduct(int productId);
+
+private:
+    bool reserveIdRange(QSqlDatabase &db, int index);
+    QString connectionName(int index) const;
+
+    QString directory;
+    QString baseName;
+    int count;
+    int stride;
+    std::vector<QSqlDatabase> shards;
+};
+
+#endif // SHARDROUTER_H
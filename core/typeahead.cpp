@@ -0,0 +1,469 @@
+#include "typeahead.h"
+#include "changefeed.h"
+#include "hotqueries.h"
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#include <algorithm>
+#include <unordered_set>
+#include <mutex>
+
+namespace {
+
+// 销量降序，其次名称升序
+bool ranksBefore(int popularityA, std::string_view keyA, int idA, int popularityB, std::string_view keyB, int idB) {
+    if (popularityA != popularityB) {
+        return popularityA > popularityB;
+    }
+    if (keyA != keyB) {
+        return keyA < keyB;
+    }
+    return idA < idB;
+}
+
+bool startsWith(std::string_view key, std::string_view prefix) {
+    return key.substr(0, prefix.size()) == prefix;
+}
+
+template <typename Range>
+int rangeLength(const Range &range) {
+    return static_cast<int>(range.second - range.first);
+}
+
+} // namespace
+
+ProductTypeahead::~ProductTypeahead() {
+    detach();
+}
+
+std::string ProductTypeahead::normalize(const QString &name) {
+    return name.simplified().toCaseFolded().toStdString();
+}
+
+std::string_view ProductTypeahead::keyOf(const Entry &entry) const {
+    return std::string_view(pool.data() + entry.offset, entry.length);
+}
+
+bool ProductTypeahead::entryLess(const Entry &a, const Entry &b) const {
+    std::string_view keyA = keyOf(a), keyB = keyOf(b);
+    return keyA != keyB ? keyA < keyB : a.productId < b.productId;
+}
+
+bool ProductTypeahead::build(QSqlDatabase &db) {
+    QSqlQuery query(db);
+    query.setForwardOnly(true);
+    if (!query.exec("SELECT productId, SUM(quantity) FROM Orders GROUP BY productId")) {
+        qDebug() << "Error loading sales for typeahead:" << query.lastError().text();
+        return false;
+    }
+    std::unordered_map<int, int> sales;
+    while (query.next()) {
+        sales[query.value(0).toInt()] = query.value(1).toInt();
+    }
+
+    if (!query.exec("SELECT productId, name FROM Products")) {
+        qDebug() << "Error loading products for typeahead:" << query.lastError().text();
+        return false;
+    }
+    std::string newPool;
+    std::vector<Entry> newEntries;
+    while (query.next()) {
+        int productId = query.value(0).toInt();
+        std::string key = normalize(query.value(1).toString());
+        auto it = sales.find(productId);
+        newEntries.push_back({static_cast<quint32>(newPool.size()), static_cast<quint32>(key.size()), productId,
+                              it != sales.end() ? it->second : 0});
+        newPool += key;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    pool.swap(newPool);
+    entries.swap(newEntries);
+    std::sort(entries.begin(), entries.end(), [this](const Entry &a, const Entry &b) { return entryLess(a, b); });
+    recent.clear();
+    liveCount = static_cast<int>(entries.size());
+    deadCount = 0;
+    ++version;
+    rebuildIndex();
+    prewarmCache();
+    return true;
+}
+
+void ProductTypeahead::attach(const QSqlDatabase &db) {
+    if (feedToken != 0) {
+        return;
+    }
+    source = db;
+    feedToken = ChangeFeed::instance().subscribe([this](const ChangeEvent &event) {
+        if (event.table == ChangeTable::Orders) {
+            if (event.type == ChangeType::Insert) {
+                recordPurchase(event.productId);
+            }
+            return;
+        }
+        if (event.type == ChangeType::Delete) {
+            removeProduct(event.productId);
+        } else if (event.type == ChangeType::Insert) {
+            QSqlQuery query(source);
+            query.prepare(HotQueries::PRODUCT_NAME_BY_ID);
+            query.bindValue(":productId", event.productId);
+            if (query.exec() && query.next()) {
+                addProduct(event.productId, query.value(0).toString());
+            }
+        }
+    });
+}
+
+void ProductTypeahead::detach() {
+    if (feedToken != 0) {
+        ChangeFeed::instance().unsubscribe(feedToken);
+        feedToken = 0;
+    }
+}
+
+ProductTypeahead::Entry *ProductTypeahead::findEntry(int productId) {
+    auto it = std::lower_bound(byId.begin(), byId.end(), std::make_pair(productId, quint32(0)));
+    if (it != byId.end() && it->first == productId && entries[it->second].popularity >= 0) {
+        return &entries[it->second];
+    }
+    for (Entry &entry : recent) {
+        if (entry.productId == productId && entry.popularity >= 0) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void ProductTypeahead::addProduct(int productId, const QString &name) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (findEntry(productId)) {
+        return;
+    }
+    std::string key = normalize(name);
+    Entry entry{static_cast<quint32>(pool.size()), static_cast<quint32>(key.size()), productId, 0};
+    pool += key;
+    recent.insert(std::upper_bound(recent.begin(), recent.end(), entry,
+                                   [this](const Entry &a, const Entry &b) { return entryLess(a, b); }),
+                  entry);
+    ++liveCount;
+    ++version;
+
+    // 已缓存的前缀就地维护，未缓存的等下次查询时再算
+    for (size_t length = 0; length <= key.size(); ++length) {
+        auto it = topByPrefix.find(key.substr(0, length));
+        if (it != topByPrefix.end()) {
+            offer(it->second, {productId, 0, key}, cacheSize);
+        }
+    }
+
+    if (static_cast<int>(recent.size()) > MERGE_THRESHOLD) {
+        compact();
+    }
+}
+
+void ProductTypeahead::removeProduct(int productId) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    Entry *entry = findEntry(productId);
+    if (!entry) {
+        return;
+    }
+    std::string key(keyOf(*entry));
+    entry->popularity = -1;
+    --liveCount;
+    ++deadCount;
+    ++version;
+
+    // 被删商品在缓存的 top-N 中时就地重算；从长到短，重算父前缀时子前缀的缓存已经是新的
+    for (size_t length = key.size() + 1; length-- > 0;) {
+        std::string prefix = key.substr(0, length);
+        auto it = topByPrefix.find(prefix);
+        if (it == topByPrefix.end()) {
+            continue;
+        }
+        RankedList &list = it->second;
+        if (std::any_of(list.begin(), list.end(), [productId](const Ranked &r) { return r.productId == productId; })) {
+            list = mergeTop(prefix);
+        }
+    }
+
+    if (deadCount > MERGE_THRESHOLD && deadCount * 8 > liveCount) {
+        compact();
+    }
+}
+
+void ProductTypeahead::recordPurchase(int productId, int quantity) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    Entry *entry = findEntry(productId);
+    if (!entry || quantity <= 0) {
+        return;
+    }
+    entry->popularity += quantity;
+    int popularity = entry->popularity;
+    std::string key(keyOf(*entry));
+    ++version;
+
+    // 销量只增不减：已在 top-N 中的重新排序，不在的尝试挤进去
+    for (size_t length = 0; length <= key.size(); ++length) {
+        auto it = topByPrefix.find(key.substr(0, length));
+        if (it == topByPrefix.end()) {
+            continue;
+        }
+        RankedList &list = it->second;
+        auto found = std::find_if(list.begin(), list.end(), [productId](const Ranked &r) { return r.productId == productId; });
+        if (found != list.end()) {
+            found->popularity = popularity;
+            std::sort(list.begin(), list.end(), [](const Ranked &a, const Ranked &b) {
+                return ranksBefore(a.popularity, a.key, a.productId, b.popularity, b.key, b.productId);
+            });
+        } else {
+            offer(list, {productId, popularity, key}, cacheSize);
+        }
+    }
+}
+
+void ProductTypeahead::offer(RankedList &list, const Ranked &candidate, int limit) const {
+    if (static_cast<int>(list.size()) >= limit) {
+        const Ranked &last = list.back();
+        if (!ranksBefore(candidate.popularity, candidate.key, candidate.productId, last.popularity, last.key, last.productId)) {
+            return;
+        }
+    }
+    auto pos = std::find_if(list.begin(), list.end(), [&candidate](const Ranked &r) {
+        return ranksBefore(candidate.popularity, candidate.key, candidate.productId, r.popularity, r.key, r.productId);
+    });
+    list.insert(pos, candidate);
+    if (static_cast<int>(list.size()) > limit) {
+        list.pop_back();
+    }
+}
+
+// 有序数组中名称以 prefix 开头的连续区间
+ProductTypeahead::EntryRange ProductTypeahead::rangeOf(const std::vector<Entry> &array, std::string_view prefix) const {
+    auto begin = std::lower_bound(array.begin(), array.end(), prefix,
+                                  [this](const Entry &entry, std::string_view p) { return keyOf(entry) < p; });
+    auto end = std::partition_point(begin, array.end(),
+                                    [this, prefix](const Entry &entry) { return startsWith(keyOf(entry), prefix); });
+    return {begin, end};
+}
+
+ProductTypeahead::RankedList ProductTypeahead::scanTop(std::string_view prefix, int limit) const {
+    RankedList top;
+    int count = 0;
+    for (const std::vector<Entry> *array : {&entries, &recent}) {
+        auto it = std::lower_bound(array->begin(), array->end(), prefix,
+                                   [this](const Entry &entry, std::string_view p) { return keyOf(entry) < p; });
+        for (; it != array->end(); ++it) {
+            std::string_view key = keyOf(*it);
+            if (!startsWith(key, prefix)) {
+                break;
+            }
+            if (it->popularity < 0) {
+                continue;
+            }
+            ++count;
+            // 先与当前最后一名比较，避免为落选者构造字符串
+            if (static_cast<int>(top.size()) >= limit) {
+                const Ranked &last = top.back();
+                if (!ranksBefore(it->popularity, key, it->productId, last.popularity, last.key, last.productId)) {
+                    continue;
+                }
+            }
+            offer(top, {it->productId, it->popularity, std::string(key)}, limit);
+        }
+    }
+    scanned.fetch_add(count, std::memory_order_relaxed);
+    return top;
+}
+
+// 由下一级前缀拼出 prefix 的 top-N：已缓存的子前缀直接取其列表，其余子前缀和恰好等于 prefix 的名称逐条比较。
+// 子前缀命中超过 HOT_RANGE 时都已缓存，所以逐条比较的部分有上界
+ProductTypeahead::RankedList ProductTypeahead::mergeTop(const std::string &prefix) const {
+    RankedList top;
+    int count = 0;
+    auto consider = [&](const Entry &entry) {
+        if (entry.popularity < 0) {
+            return;
+        }
+        ++count;
+        offer(top, {entry.productId, entry.popularity, std::string(keyOf(entry))}, cacheSize);
+    };
+    EntryRange inEntries = rangeOf(entries, prefix);
+    EntryRange inRecent = rangeOf(recent, prefix);
+    auto i = inEntries.first, iEnd = inEntries.second;
+    auto j = inRecent.first, jEnd = inRecent.second;
+
+    // 名称恰好等于 prefix 的排在范围最前
+    for (; i != iEnd && keyOf(*i).size() == prefix.size(); ++i) {
+        consider(*i);
+    }
+    for (; j != jEnd && keyOf(*j).size() == prefix.size(); ++j) {
+        consider(*j);
+    }
+
+    std::string child = prefix + ' ';
+    while (i != iEnd || j != jEnd) {
+        // 两个数组中下一个子前缀取较小者（按字节无符号比较，与 string_view 的顺序一致）
+        unsigned char next = 0xff;
+        if (i != iEnd) {
+            next = static_cast<unsigned char>(keyOf(*i)[prefix.size()]);
+        }
+        if (j != jEnd) {
+            next = std::min(next, static_cast<unsigned char>(keyOf(*j)[prefix.size()]));
+        }
+        child.back() = static_cast<char>(next);
+        auto inChild = [&](const Entry &entry) { return startsWith(keyOf(entry), child); };
+        auto iNext = std::partition_point(i, iEnd, inChild);
+        auto jNext = std::partition_point(j, jEnd, inChild);
+
+        auto cached = topByPrefix.find(child);
+        if (cached != topByPrefix.end()) {
+            for (const Ranked &ranked : cached->second) {
+                offer(top, ranked, cacheSize);
+            }
+        } else {
+            std::for_each(i, iNext, consider);
+            std::for_each(j, jNext, consider);
+        }
+        i = iNext;
+        j = jNext;
+    }
+    scanned.fetch_add(count, std::memory_order_relaxed);
+    return top;
+}
+
+std::vector<Suggestion> ProductTypeahead::complete(const QString &prefix, int limit) const {
+    std::vector<Suggestion> suggestions;
+    if (limit <= 0) {
+        return suggestions;
+    }
+    std::string key = normalize(prefix);
+    bool cacheable = limit <= cacheSize;
+
+    RankedList top;
+    bool hot = false;
+    quint64 scannedVersion = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = cacheable ? topByPrefix.find(key) : topByPrefix.end();
+        if (it != topByPrefix.end()) {
+            top.assign(it->second.begin(), it->second.begin() + std::min<size_t>(limit, it->second.size()));
+        } else if (cacheable && rangeLength(rangeOf(entries, key)) + rangeLength(rangeOf(recent, key)) > HOT_RANGE) {
+            // 上次压缩后才变热的前缀：由子前缀合并，之后缓存
+            top = mergeTop(key);
+            hot = true;
+            scannedVersion = version;
+        } else {
+            top = scanTop(key, cacheable ? cacheSize : limit);
+        }
+    }
+
+    // 期间索引若被修改则放弃回填，以免缓存过期结果
+    if (hot) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        if (version == scannedVersion) {
+            topByPrefix.emplace(key, top);
+        }
+    }
+
+    for (int i = 0; i < static_cast<int>(top.size()) && i < limit; ++i) {
+        suggestions.push_back({top[i].productId, top[i].popularity});
+    }
+    return suggestions;
+}
+
+int ProductTypeahead::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return liveCount;
+}
+
+void ProductTypeahead::rebuildIndex() {
+    byId.clear();
+    byId.reserve(entries.size());
+    for (quint32 i = 0; i < entries.size(); ++i) {
+        byId.emplace_back(entries[i].productId, i);
+    }
+    std::sort(byId.begin(), byId.end());
+}
+
+// 只在 build() 和 compact() 之后调用，此时没有增量和已删除条目。
+// 先借助相邻名称的公共前缀长度找出命中超过 HOT_RANGE 的前缀，再一次遍历为需要缓存的前缀计算 top-N
+void ProductTypeahead::prewarmCache() {
+    topByPrefix.clear();
+    std::unordered_set<std::string> hot;
+    std::vector<size_t> runStart;  // runStart[L]：长度为 L 的当前前缀从哪个条目开始
+    std::string_view previous;
+    auto closeRuns = [&](size_t from, size_t end) {
+        for (size_t length = from; length < runStart.size(); ++length) {
+            if (end - runStart[length] > static_cast<size_t>(HOT_RANGE)) {
+                hot.emplace(previous.substr(0, length));
+            }
+        }
+        runStart.resize(std::min(from, runStart.size()));
+    };
+    for (size_t i = 0; i < entries.size(); ++i) {
+        std::string_view key = keyOf(entries[i]);
+        size_t common = 0;
+        while (common < key.size() && common < previous.size() && key[common] == previous[common]) {
+            ++common;
+        }
+        closeRuns(common + 1, i);
+        while (runStart.size() <= key.size()) {
+            runStart.push_back(i);
+        }
+        previous = key;
+    }
+    closeRuns(0, entries.size());
+
+    // 缓存短前缀和热门前缀的下一级前缀；这个集合对前缀封闭，遇到第一个不缓存的长度即可停止
+    for (const Entry &entry : entries) {
+        std::string_view key = keyOf(entry);
+        for (size_t length = 0; length <= key.size(); ++length) {
+            std::string prefix(key.substr(0, length));
+            if (length > static_cast<size_t>(CACHED_PREFIX_BYTES) && !hot.count(prefix.substr(0, length - 1))) {
+                break;
+            }
+            RankedList &list = topByPrefix[prefix];
+            if (static_cast<int>(list.size()) >= cacheSize) {
+                const Ranked &last = list.back();
+                if (!ranksBefore(entry.popularity, key, entry.productId, last.popularity, last.key, last.productId)) {
+                    continue;
+                }
+            }
+            offer(list, {entry.productId, entry.popularity, std::string(key)}, cacheSize);
+        }
+    }
+}
+
+// 合并增量数组并丢弃已删除条目，同时压缩字符池，然后按新的范围重算缓存
+void ProductTypeahead::compact() {
+    std::string newPool;
+    std::vector<Entry> merged;
+    merged.reserve(liveCount);
+
+    auto keep = [&](const Entry &entry) {
+        std::string_view key = keyOf(entry);
+        merged.push_back({static_cast<quint32>(newPool.size()), static_cast<quint32>(key.size()), entry.productId,
+                          entry.popularity});
+        newPool.append(key.data(), key.size());
+    };
+
+    size_t i = 0, j = 0;
+    while (i < entries.size() || j < recent.size()) {
+        if (i < entries.size() && entries[i].popularity < 0) {
+            ++i;
+        } else if (j < recent.size() && recent[j].popularity < 0) {
+            ++j;
+        } else if (j >= recent.size() || (i < entries.size() && entryLess(entries[i], recent[j]))) {
+            keep(entries[i++]);
+        } else {
+            keep(recent[j++]);
+        }
+    }
+
+    pool.swap(newPool);
+    entries.swap(merged);
+    recent.clear();
+    deadCount = 0;
+    rebuildIndex();
+    prewarmCache();
+}
@@ -0,0 +1,102 @@
+#ifndef TYPEAHEAD_H
+#define TYPEAHEAD_H
+
+#include <QString>
+#include <QtSql/QSqlDatabase>
+#include <atomic>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// 一条补全建议
+struct Suggestion {
+    int productId;
+    int popularity;  // 累计销量
+};
+
+// 商品名前缀补全索引（内存）。
+// 规范化后的名称（simplified + 大小写折叠，UTF-8）连续存放在一个字符池里，按名称排序的定长条目指向它，
+// 前缀查找是一次二分加范围扫描；新商品先进入有序的小增量数组，积累到阈值或删除过多时合并压缩。
+// 短前缀、命中超过 HOT_RANGE 的前缀及其下一级前缀在 build()/压缩时缓存 top-N，发布/下架/下单时就地维护；
+// 下架挤出缓存中的商品时，由下一级前缀的缓存合并重算，不扫描整个范围，首次查询和删除后的查询同样不扫描。
+// attach() 后随 ChangeFeed 增量更新；complete() 只读内存，不产生 SQL。
+class ProductTypeahead {
+public:
+    static const int DEFAULT_LIMIT = 10;
+    static const int CACHED_PREFIX_BYTES = 2;  // build() 时预先缓存的前缀长度
+    static const int HOT_RANGE = 2048;         // 命中超过此数量的前缀连同其下一级前缀都缓存
+    static const int MERGE_THRESHOLD = 1024;
+
+    explicit ProductTypeahead(int cacheSize = DEFAULT_LIMIT) : cacheSize(cacheSize > 0 ? cacheSize : DEFAULT_LIMIT) {}
+    ~ProductTypeahead();
+
+    ProductTypeahead(const ProductTypeahead &) = delete;
+    ProductTypeahead &operator=(const ProductTypeahead &) = delete;
+
+    // 从 Products/Orders 全量重建
+    bool build(QSqlDatabase &db);
+
+    // 订阅 ChangeFeed：发布时从 db 读取新商品名称，下架时移除，下单时累加销量
+    void attach(const QSqlDatabase &db);
+    void detach();
+
+    // 增量更新入口
+    void addProduct(int productId, const QString &name);
+    void removeProduct(int productId);
+    void recordPurchase(int productId, int quantity = 1);
+
+    // 名称以 prefix 开头的商品，按销量降序、名称升序，最多 limit 条
+    std::vector<Suggestion> complete(const QString &prefix, int limit = DEFAULT_LIMIT) const;
+
+    int size() const;
+
+    // 查询累计扫描过的条目数（命中缓存的查询不增加），用于观察缓存效果
+    quint64 scannedEntries() const { return scanned.load(std::memory_order_relaxed); }
+
+    static std::string normalize(const QString &name);
+
+private:
+    struct Entry {
+        quint32 offset;   // 名称在 pool 中的位置
+        quint32 length;
+        int productId;
+        int popularity;   // < 0 表示已删除，等待压缩
+    };
+    struct Ranked {
+        int productId;
+        int popularity;
+        std::string key;
+    };
+    using RankedList = std::vector<Ranked>;
+
+    std::string_view keyOf(const Entry &entry) const;
+    bool entryLess(const Entry &a, const Entry &b) const;
+    Entry *findEntry(int productId);
+    using EntryRange = std::pair<std::vector<Entry>::const_iterator, std::vector<Entry>::const_iterator>;
+    EntryRange rangeOf(const std::vector<Entry> &array, std::string_view prefix) const;
+    RankedList scanTop(std::string_view prefix, int limit) const;
+    RankedList mergeTop(const std::string &prefix) const;
+    void offer(RankedList &list, const Ranked &candidate, int limit) const;
+    void rebuildIndex();
+    void prewarmCache();
+    void compact();
+
+    int cacheSize;
+    int feedToken = 0;
+    QSqlDatabase source;
+
+    mutable std::shared_mutex mutex;
+    std::string pool;
+    std::vector<Entry> entries;                  // 有序主数组
+    std::vector<Entry> recent;                   // 有序增量数组
+    std::vector<std::pair<int, quint32>> byId;   // productId -> entries 下标，按 productId 有序
+    int liveCount = 0;
+    int deadCount = 0;
+    quint64 version = 0;                         // 每次修改递增，用于查询后回填缓存时的校验
+    mutable std::unordered_map<std::string, RankedList> topByPrefix;
+    mutable std::atomic<quint64> scanned{0};
+};
+
+#endif // TYPEAHEAD_H
@@ -1,7 +1,15 @@
 #include "user.h"
+#include "eventjournal.h"
+#include "hotqueries.h"
 #include <QDebug>
 #include <QCryptographicHash>  // 用于密码哈希
 #include <QRandomGenerator>
+#include <QElapsedTimer>
+#include <atomic>
+
+const char *const User::HASH_ALGORITHM = "sha256-iter";
+
+static std::atomic<int> configuredIterations{User::DEFAULT_PBKDF2_ITERATIONS};
 
 // Helper: generate a per-user random salt (hex)
 QString User::generateSalt(int length) {
@@ -24,22 +32,87 @@ QString User::hashPassword(const QString &password, const QString &salt, int ite
     return result.toHex();
 }
 
+int User::defaultIterations() {
+    return configuredIterations;
+}
+
+void User::setDefaultIterations(int iterations) {
+    configuredIterations = qBound<int>(MIN_PBKDF2_ITERATIONS, iterations, MAX_PBKDF2_ITERATIONS);
+}
+
+int User::calibrateIterations(int targetMs) {
+    if (targetMs <= 0) {
+        return defaultIterations();
+    }
+    // 探测轮数逐次加倍，直到单次测量超过 20ms，减小计时误差
+    const QString salt = generateSalt();
+    int probe = MIN_PBKDF2_ITERATIONS;
+    qint64 elapsedNs = 0;
+    QElapsedTimer timer;
+    for (;;) {
+        timer.start();
+        hashPassword("calibration", salt, probe);
+        elapsedNs = qMax<qint64>(timer.nsecsElapsed(), 1);
+        if (elapsedNs >= 20 * 1000 * 1000 || probe >= MAX_PBKDF2_ITERATIONS) {
+            break;
+        }
+        probe = qMin<int>(probe * 2, MAX_PBKDF2_ITERATIONS);
+    }
+    qint64 iterations = static_cast<qint64>(targetMs) * 1000 * 1000 * probe / elapsedNs;
+    iterations = iterations / 1000 * 1000;
+    return static_cast<int>(qBound<qint64>(MIN_PBKDF2_ITERATIONS, iterations, MAX_PBKDF2_ITERATIONS));
+}
+
+void User::configureHashing(const QSettings &settings) {
+    int iterations = settings.value("security/hashIterations", 0).toInt();
+    int targetMs = settings.value("security/hashTargetMs", 0).toInt();
+    if (iterations > 0) {
+        setDefaultIterations(iterations);
+    } else if (targetMs > 0) {
+        setDefaultIterations(calibrateIterations(targetMs));
+    }
+    qDebug() << "Password hashing:" << HASH_ALGORITHM << defaultIterations() << "iterations";
+}
+
+bool User::storeCredentials(QSqlDatabase &db, const QString &plainPassword) {
+    int iterations = defaultIterations();
+    QString newSalt = User::generateSalt();
+    QSqlQuery query(db);
+    query.prepare("UPDATE Users SET password = :password, salt = :salt, hashAlgorithm = :hashAlgorithm, "
+                  "iterations = :iterations WHERE userId = :userId");
+    query.bindValue(":password", User::hashPassword(plainPassword, newSalt, iterations));
+    query.bindValue(":salt", newSalt);
+    query.bindValue(":hashAlgorithm", HASH_ALGORITHM);
+    query.bindValue(":iterations", iterations);
+    query.bindValue(":userId", userId);
+    if (!query.exec()) {
+        qDebug() << "Error updating user credentials:" << query.lastError().text();
+        return false;
+    }
+    salt = newSalt;
+    return true;
+}
+
 // 用户注册函数
-void User::registerUser(QSqlDatabase &db) {
+RegistrationResult User::registerUser(QSqlDatabase &db) {
 
     qDebug() << "username=" << username;
     qDebug() << "email=" << email;
     qDebug() << "role=" << role;
     // Generate per-user salt and derive password hash using iterative SHA-256
+    // 哈希参数随行保存，以后调整默认轮数不影响已有用户登录
+    int iterations = defaultIterations();
     QString newSalt = User::generateSalt();
-    QString derivedHash = User::hashPassword(password, newSalt, User::DEFAULT_PBKDF2_ITERATIONS);
+    QString derivedHash = User::hashPassword(password, newSalt, iterations);
     // Store salt along with the derived hash
     QSqlQuery query(db);
-    query.prepare("INSERT INTO Users (username, password, salt, email, role) "
-                  "VALUES (:username, :password, :salt, :email, :role)");
+    query.prepare("INSERT INTO Users (username, password, salt, hashAlgorithm, iterations, email, role) "
+                  "VALUES (:username, :password, :salt, :hashAlgorithm, :iterations, :email, :role)");
     query.bindValue(":username", username);
     query.bindValue(":password", derivedHash);
     query.bindValue(":salt", newSalt);
+    query.bindValue(":hashAlgorithm", HASH_ALGORITHM);
+    query.bindValue(":iterations", iterations);
     query.bindValue(":email", email);
     query.bindValue(":role", role);
     // keep salt in instance
@@ -47,15 +120,23 @@ void User::registerUser(QSqlDatabase &db) {
 
     if (!query.exec()) {
         qDebug() << "Error registering user:" << query.lastError().text();
-    } else {
-        qDebug() << "User registered successfully!";
+        // 唯一索引拒绝时用户名必然已存在
+        QSqlQuery exists(db);
+        exists.prepare(HotQueries::USERNAME_EXISTS);
+        exists.bindValue(":username", username);
+        if (exists.exec() && exists.next()) {
+            return RegistrationResult::UsernameTaken;
+        }
+        return RegistrationResult::Failed;
     }
+    qDebug() << "User registered successfully!";
+    return RegistrationResult::Registered;
 }
 
 // 用户登录
 bool User::login(QSqlDatabase &db, const QString &inputPassword) {
     QSqlQuery query(db);
-    query.prepare("SELECT password, salt FROM Users WHERE username = :username");
+    query.prepare(HotQueries::USER_LOGIN);
     query.bindValue(":username", username);
 
     if (!query.exec()) {
@@ -66,28 +147,37 @@ bool User::login(QSqlDatabase &db, const QString &inputPassword) {
     if (query.next()) {
         QString storedPassword = query.value(0).toString();
         QString storedSalt = query.value(1).toString();
+        int storedUserId = query.value(2).toInt();
+        QString storedAlgorithm = query.value(3).toString();
+        int storedIterations = query.value(4).isNull() ? DEFAULT_PBKDF2_ITERATIONS : query.value(4).toInt();
 
         if (storedSalt.isEmpty()) {
             // Legacy record: unsalted SHA-256(password). Verify and migrate to salted hash on successful login.
             QString legacy = QCryptographicHash::hash(inputPassword.toUtf8(), QCryptographicHash::Sha256).toHex();
             if (storedPassword == legacy) {
                 // Migrate: generate a salt and store a derived hash
-                QString newSalt = User::generateSalt();
-                QString newDerived = User::hashPassword(inputPassword, newSalt, User::DEFAULT_PBKDF2_ITERATIONS);
-                QSqlQuery updateQuery(db);
-                updateQuery.prepare("UPDATE Users SET password = :password, salt = :salt WHERE username = :username");
-                updateQuery.bindValue(":password", newDerived);
-                updateQuery.bindValue(":salt", newSalt);
-                updateQuery.bindValue(":username", username);
-                if (!updateQuery.exec()) {
-                    qDebug() << "Error migrating user password to salted hash:" << updateQuery.lastError().text();
-                }
+                userId = storedUserId;
+                storeCredentials(db, inputPassword);
+                EventJournal::record(JournalEventType::Login, {userId, username, role});
                 return true;
             }
             return false;
         } else {
-            QString derived = User::hashPassword(inputPassword, storedSalt, User::DEFAULT_PBKDF2_ITERATIONS);
-            return (storedPassword == derived);
+            if (!storedAlgorithm.isEmpty() && storedAlgorithm != HASH_ALGORITHM) {
+                qDebug() << "Unsupported password hash algorithm:" << storedAlgorithm;
+                return false;
+            }
+            QString derived = User::hashPassword(inputPassword, storedSalt, storedIterations);
+            if (storedPassword != derived) {
+                return false;
+            }
+            userId = storedUserId;  // 登录成功后使用库中的真实 userId
+            // 轮数低于当前配置的记录顺带升级；不会降级
+            if (storedIterations < defaultIterations()) {
+                storeCredentials(db, inputPassword);
+            }
+            EventJournal::record(JournalEventType::Login, {userId, username, role});
+            return true;
         }
     }
     return false;
@@ -2,10 +2,18 @@
 #define USER_H
 
 #include <QString>
+#include <QSettings>
 #include <QtSql/QSqlDatabase>
 #include <QtSql/QSqlQuery>
 #include <QtSql/QSqlError>
 
+// 注册结果
+enum class RegistrationResult {
+    Registered,
+    UsernameTaken,  // 用户名已存在（Users.username 唯一）
+    Failed          // 其他数据库错误
+};
+
 class User {
 protected:
     int userId;
@@ -15,8 +23,15 @@ protected:
     QString email;
     QString role; // 'customer' or 'merchant'
 
+    // 以当前默认参数重新加盐哈希并写回本用户的行（旧格式迁移、轮数升级）
+    bool storeCredentials(QSqlDatabase &db, const QString &plainPassword);
+
 public:
+    // 未配置时新密码使用的轮数；旧记录没有 iterations 列值时也按此轮数校验
     static const int DEFAULT_PBKDF2_ITERATIONS = 10000;
+    static const int MIN_PBKDF2_ITERATIONS = 1000;
+    static const int MAX_PBKDF2_ITERATIONS = 5000000;
+    static const char *const HASH_ALGORITHM;  // 写入 Users.hashAlgorithm 的算法标识
 
     User(int id, QString uname, QString pass, QString mail, QString r)
         : userId(id), username(uname), password(pass), salt(""), email(mail), role(r) {}
@@ -25,6 +40,17 @@ public:
     static QString generateSalt(int length = 16);
     static QString hashPassword(const QString &password, const QString &salt, int iterations = DEFAULT_PBKDF2_ITERATIONS);
 
+    // 新密码（注册、导入、登录时升级）使用的轮数，进程内可配置
+    static int defaultIterations();
+    static void setDefaultIterations(int iterations);
+
+    // 在本机测量 hashPassword，返回单次哈希约耗时 targetMs 毫秒的轮数（按 1000 取整）
+    static int calibrateIterations(int targetMs);
+
+    // 读取配置：security/hashIterations 指定固定轮数；
+    // 否则 security/hashTargetMs 指定目标耗时，启动时校准；都没有则保持当前值
+    static void configureHashing(const QSettings &settings);
+
     QString getSalt() const { return salt; }
     void setSalt(const QString &s) { salt = s; }
 
@@ -40,7 +66,7 @@ public:
     void setRole(const QString &r) { role = r; }
 
     // 用户注册
-    virtual void registerUser(QSqlDatabase &db) = 0;
+    virtual RegistrationResult registerUser(QSqlDatabase &db) = 0;
 
     // 用户登录
     virtual bool login(QSqlDatabase &db, const QString &inputPassword) = 0;
@@ -0,0 +1,216 @@
+#include "userimporter.h"
+#include "user.h"
+#include "hotqueries.h"
+#include <QFile>
+#include <QTextStream>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QDebug>
+#include <algorithm>
+#include <thread>
+
+namespace {
+
+// 读取一条 CSV 记录（可能跨多行），返回 false 表示已到文件末尾。
+// lines 累加本条记录占用的物理行数；引号未闭合就到文件末尾时 malformed 置为 true
+bool readCsvRecord(QTextStream &in, QStringList &fields, int &lines, bool &malformed) {
+    fields.clear();
+    malformed = false;
+    QString line;
+    if (!in.readLineInto(&line)) {
+        return false;
+    }
+    ++lines;
+
+    QString field;
+    bool quoted = false;
+    int i = 0;
+    while (true) {
+        if (i == line.size()) {
+            if (!quoted) {
+                break;
+            }
+            // 引号内的换行属于字段内容
+            if (!in.readLineInto(&line)) {
+                malformed = true;
+                break;
+            }
+            ++lines;
+            field += '\n';
+            i = 0;
+            continue;
+        }
+        QChar c = line[i++];
+        if (quoted) {
+            if (c != '"') {
+                field += c;
+            } else if (i < line.size() && line[i] == '"') {
+                field += '"';
+                ++i;
+            } else {
+                quoted = false;
+            }
+        } else if (c == ',') {
+            fields << field;
+            field.clear();
+        } else if (c == '"' && field.isEmpty()) {
+            quoted = true;
+        } else {
+            field += c;
+        }
+    }
+    fields << field;
+    return true;
+}
+
+} // namespace
+
+UserImporter::UserImporter(QSqlDatabase &db, int batchSize, int threads)
+    : db(db), batchSize(batchSize > 0 ? batchSize : DEFAULT_BATCH_SIZE) {
+    threadCount = threads > 0 ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    batch.reserve(this->batchSize);
+}
+
+bool UserImporter::add(const ImportedUser &user) {
+    if (user.username.isEmpty() || user.password.isEmpty() || user.email.isEmpty()
+        || (user.role != "customer" && user.role != "merchant")) {
+        result.rejected << user.username;
+        return true;
+    }
+    batch.push_back(user);
+    if (static_cast<int>(batch.size()) >= batchSize) {
+        return flushBatch();
+    }
+    return true;
+}
+
+bool UserImporter::finish() {
+    return batch.empty() || flushBatch();
+}
+
+bool UserImporter::flushBatch() {
+    // 先去重，重复的记录不浪费哈希计算
+    std::vector<ImportedUser> accepted;
+    accepted.reserve(batch.size());
+    QSqlQuery exists(db);
+    exists.prepare(HotQueries::USERNAME_EXISTS);
+    for (ImportedUser &user : batch) {
+        if (seen.contains(user.username)) {
+            result.duplicates << user.username;
+            continue;
+        }
+        exists.bindValue(":username", user.username);
+        if (!exists.exec()) {
+            error = exists.lastError().text();
+            qDebug() << "Error checking username:" << error;
+            return false;
+        }
+        if (exists.next()) {
+            result.duplicates << user.username;
+            continue;
+        }
+        seen.insert(user.username);
+        accepted.push_back(std::move(user));
+    }
+    exists.finish();
+    batch.clear();
+    if (accepted.empty()) {
+        return true;
+    }
+
+    // 加盐哈希占绝大部分时间，按线程交错分片并行计算
+    const int iterations = User::defaultIterations();
+    std::vector<QString> salts(accepted.size());
+    std::vector<QString> hashes(accepted.size());
+    int workersNeeded = std::min<int>(threadCount, static_cast<int>(accepted.size()));
+    std::vector<std::thread> workers;
+    for (int t = 0; t < workersNeeded; ++t) {
+        workers.emplace_back([&, t]() {
+            for (size_t i = t; i < accepted.size(); i += workersNeeded) {
+                salts[i] = User::generateSalt();
+                hashes[i] = User::hashPassword(accepted[i].password, salts[i], iterations);
+            }
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+
+    // 整批一个事务写入
+    if (!db.transaction()) {
+        error = db.lastError().text();
+        qDebug() << "Error starting import transaction:" << error;
+        return false;
+    }
+    QSqlQuery insert(db);
+    // 用户名以唯一索引为准：预检之后被并发导入/注册抢先写入的记录被忽略并计为重复
+    QStringList raced;
+    insert.prepare("INSERT OR IGNORE INTO Users (username, password, salt, hashAlgorithm, iterations, email, role) "
+                   "VALUES (:username, :password, :salt, :hashAlgorithm, :iterations, :email, :role)");
+    for (size_t i = 0; i < accepted.size(); ++i) {
+        insert.bindValue(":username", accepted[i].username);
+        insert.bindValue(":password", hashes[i]);
+        insert.bindValue(":salt", salts[i]);
+        insert.bindValue(":hashAlgorithm", User::HASH_ALGORITHM);
+        insert.bindValue(":iterations", iterations);
+        insert.bindValue(":email", accepted[i].email);
+        insert.bindValue(":role", accepted[i].role);
+        if (!insert.exec()) {
+            error = insert.lastError().text();
+            qDebug() << "Error importing user:" << error;
+            db.rollback();
+            for (const ImportedUser &user : accepted) {
+                seen.remove(user.username);
+            }
+            return false;
+        }
+        if (insert.numRowsAffected() == 0) {
+            raced << accepted[i].username;
+        }
+    }
+    if (!db.commit()) {
+        error = db.lastError().text();
+        qDebug() << "Error committing user import:" << error;
+        db.rollback();
+        for (const ImportedUser &user : accepted) {
+            seen.remove(user.username);
+        }
+        return false;
+    }
+    result.imported += static_cast<int>(accepted.size()) - raced.size();
+    result.duplicates += raced;
+    return true;
+}
+
+bool UserImporter::importCsv(const QString &filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        error = file.errorString();
+        qDebug() << "Cannot open user import file" << filePath << ":" << error;
+        return false;
+    }
+    QTextStream in(&file);
+    int lines = 0;
+    QStringList fields;
+    bool malformed = false;
+    while (true) {
+        int lineNumber = lines + 1;  // 记录起始行号
+        if (!readCsvRecord(in, fields, lines, malformed)) {
+            break;
+        }
+        if (fields.size() == 1 && fields[0].trimmed().isEmpty()) {
+            continue;
+        }
+        if (lineNumber == 1 && fields.value(0).trimmed() == "username") {
+            continue;  // 表头
+        }
+        if (malformed || fields.size() != 4) {
+            result.rejected << QString("line %1").arg(lineNumber);
+            continue;
+        }
+        if (!add({fields[0].trimmed(), fields[1], fields[2].trimmed(), fields[3].trimmed()})) {
+            return false;
+        }
+    }
+    return finish();
+}
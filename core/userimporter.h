@@ -0,0 +1,61 @@
+#ifndef USERIMPORTER_H
+#define USERIMPORTER_H
+
+#include <QString>
+#include <QStringList>
+#include <QSet>
+#include <QtSql/QSqlDatabase>
+#include <vector>
+
+// 待导入的一条用户记录（明文密码）
+struct ImportedUser {
+    QString username;
+    QString password;
+    QString email;
+    QString role;  // 'customer' or 'merchant'
+};
+
+// 导入结果
+struct ImportReport {
+    int imported = 0;
+    QStringList duplicates;  // 库中已存在或本次导入中重复的用户名（只导入第一次出现的）
+    QStringList rejected;    // 字段不完整或角色无效的用户名/行号
+};
+
+// 批量用户导入。
+// 记录逐条 add()，攒满一批后：先按用户名预先去重（查库走 idx_users_username_unique），
+// 再把加盐哈希分摊到所有核心并行计算，最后在一个事务中写入整批。
+// 预检只为省下重复记录的哈希计算；以唯一索引为准，并发导入时被约束拦下的记录同样计入 duplicates。
+// 写入的 salt/password/哈希参数与 User::registerUser 完全相同，导入的用户可直接 User::login。
+class UserImporter {
+public:
+    static const int DEFAULT_BATCH_SIZE = 2000;
+
+    explicit UserImporter(QSqlDatabase &db, int batchSize = DEFAULT_BATCH_SIZE, int threads = 0);
+
+    // 追加一条记录，批满时写入；写库失败返回 false
+    bool add(const ImportedUser &user);
+
+    // 写入剩余记录
+    bool finish();
+
+    // 从 CSV（username,password,email,role，可带表头）流式导入。
+    // 按 RFC 4180 解析：字段可用双引号包围，引号内可含逗号、换行，"" 表示一个引号
+    bool importCsv(const QString &filePath);
+
+    const ImportReport &report() const { return result; }
+    QString lastError() const { return error; }
+
+private:
+    bool flushBatch();
+
+    QSqlDatabase &db;
+    int batchSize;
+    int threadCount;
+    std::vector<ImportedUser> batch;
+    QSet<QString> seen;  // 本次导入已接受的用户名
+    ImportReport result;
+    QString error;
+};
+
+#endif // USERIMPORTER_H
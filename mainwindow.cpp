@@ -1,83 +1,16 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
 #include <QMessageBox>
+#include <QListWidgetItem>
+#include <QStatusBar>
+#include <QSettings>
 
 #include <QSqlDatabase>
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
 
-void createTables(QSqlDatabase &db) {
-    // 检查数据库是否打开
-    if (!db.isOpen()) {
-        qDebug() << "Database is not open!";
-        return;
-    }
-
-    // 创建 Users 表
-    QSqlQuery query(db);
-    query.exec("CREATE TABLE IF NOT EXISTS Users ("
-               "userId INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "username TEXT NOT NULL, "
-               "password TEXT NOT NULL, "
-               "email TEXT NOT NULL, "
-               "role TEXT NOT NULL)");
-
-    if (query.lastError().isValid()) {
-        qDebug() << "Error creating Users table:" << query.lastError().text();
-    } else {
-        qDebug() << "Users table created successfully.";
-    }
-
-    // Ensure backward compatibility: add `salt` column if it doesn't exist (for older DBs)
-    bool hasSalt = false;
-    query.exec("PRAGMA table_info(Users)");
-    while (query.next()) {
-        QString colName = query.value(1).toString(); // column name is at index 1
-        if (colName == "salt") {
-            hasSalt = true;
-            break;
-        }
-    }
-    if (!hasSalt) {
-        qDebug() << "Adding missing 'salt' column to Users table.";
-        if (!query.exec("ALTER TABLE Users ADD COLUMN salt TEXT")) {
-            qDebug() << "Error adding salt column:" << query.lastError().text();
-        } else {
-            qDebug() << "Added 'salt' column to Users table.";
-        }
-    }
-
-    // 创建 Products 表
-    query.exec("CREATE TABLE IF NOT EXISTS Products ("
-               "productId INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "name TEXT NOT NULL, "
-               "description TEXT, "
-               "price REAL NOT NULL, "
-               "image TEXT)");
-
-    if (query.lastError().isValid()) {
-        qDebug() << "Error creating Products table:" << query.lastError().text();
-    } else {
-        qDebug() << "Products table created successfully.";
-    }
-
-    // 创建 Orders 表
-    query.exec("CREATE TABLE IF NOT EXISTS Orders ("
-               "orderId INTEGER PRIMARY KEY AUTOINCREMENT, "
-               "customerId INTEGER NOT NULL, "
-               "productId INTEGER NOT NULL, "
-               "quantity INTEGER NOT NULL, "
-               "orderDate TEXT NOT NULL, "
-               "FOREIGN KEY (customerId) REFERENCES Users(userId), "
-               "FOREIGN KEY (productId) REFERENCES Products(productId))");
-
-    if (query.lastError().isValid()) {
-        qDebug() << "Error creating Orders table:" << query.lastError().text();
-    } else {
-        qDebug() << "Orders table created successfully.";
-    }
-}
+#include "core/schema.h"
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -93,35 +26,195 @@ MainWindow::MainWindow(QWidget *parent) :
     }
     createTables(db);
 
+    // 密码哈希轮数由 ShopLink.ini 配置（固定轮数或目标耗时），未配置时使用默认值
+    QSettings settings("ShopLink.ini", QSettings::IniFormat);
+    User::configureHashing(settings);
+
     currentUser = nullptr;  // 默认没有用户登录
+
+    // 订阅商品变更，发布/下架后只更新受影响的列表项
+    changeFeedToken = ChangeFeed::instance().subscribe([this](const ChangeEvent &event) {
+        if (event.table != ChangeTable::Products) {
+            return;
+        }
+        QMetaObject::invokeMethod(this, [this, event]() { applyProductChange(event); });
+    });
+
+    vacuumScheduler.reset(new IncrementalVacuumScheduler(db));
+    vacuumScheduler->start();
+
+    // 每小时在线备份一次，保留最近 24 份
+    backupService.reset(new BackupService(db.databaseName(), "backups", 24));
+    backupService->start(60 * 60 * 1000);
+
+    // 业务事件写入只追加日志，只保留最近 8 个已写满的段
+    journal = std::make_shared<EventJournal>("journal");
+    if (journal->open()) {
+        journal->retainSegments(8);
+        EventJournal::setActive(journal);
+    }
+
+    // 每分钟在后台线程检查一次到期的价格活动
+    campaignScheduler.reset(new CampaignScheduler(db.databaseName()));
+    campaignScheduler->start(60 * 1000);
+
+    // 推荐表启动时构建一次，之后随订单增量更新
+    recommender.build(db);
+    recommender.attach();
+    connect(ui->productListWidget, &QListWidget::currentItemChanged, this,
+            [this](QListWidgetItem *current, QListWidgetItem *) { showRecommendations(current); });
+    connect(ui->productListWidget, &QListWidget::itemDoubleClicked, this,
+            [this](QListWidgetItem *item) { showProductDetails(item); });
+
+    // 搜索框每次按键都从内存前缀索引取建议，选中后定位到列表项
+    typeahead.build(db);
+    typeahead.attach(db);
+    suggestionModel = new QStandardItemModel(this);
+    searchCompleter = new QCompleter(suggestionModel, this);
+    searchCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    ui->searchLineEdit->setCompleter(searchCompleter);
+    connect(ui->searchLineEdit, &QLineEdit::textEdited, this,
+            [this](const QString &text) { updateSearchSuggestions(text); });
+    connect(searchCompleter, qOverload<const QModelIndex &>(&QCompleter::activated), this,
+            [this](const QModelIndex &index) {
+                if (QListWidgetItem *item = productItems.value(index.data(Qt::UserRole).toInt(), nullptr)) {
+                    ui->productListWidget->setCurrentItem(item);
+                    ui->productListWidget->scrollToItem(item);
+                }
+            });
 }
 
 MainWindow::~MainWindow()
 {
+    backupService->stop();
+    campaignScheduler->stop();
+    EventJournal::setActive(nullptr);
+    journal->close();
+    ChangeFeed::instance().unsubscribe(changeFeedToken);
     delete ui;
     db.close();  // 关闭数据库
 }
 
-void MainWindow::loadProducts()
+// 列表只显示名称和价格，描述在详情中查看
+static QString formatProductInfo(const QString &name, float price)
+{
+    return QString("Name: %1\nPrice: $%2")
+        .arg(name)
+        .arg(price);
+}
+
+void MainWindow::addProductItem(int productId, const QString &productName, const QString &productInfo)
+{
+    QListWidgetItem *item = new QListWidgetItem(productInfo);
+    item->setData(Qt::UserRole, productId);
+    item->setData(Qt::UserRole + 1, productName);
+    ui->productListWidget->addItem(item);
+    productItems.insert(productId, item);
+}
+
+void MainWindow::applyProductChange(const ChangeEvent &event)
+{
+    // 列表尚未加载（未登录）时忽略，登录后 loadProducts() 会读到最新数据
+    if (!productsLoaded) {
+        return;
+    }
+
+    // 只处理受影响的那一行，代价与变更量成正比而不是与商品总数成正比
+    QListWidgetItem *existing = productItems.value(event.productId, nullptr);
+
+    if (event.type == ChangeType::Reload) {
+        loadProducts();  // 大批量变更：整体重载一次列表
+        return;
+    }
+
+    if (event.type == ChangeType::Delete) {
+        productItems.remove(event.productId);
+        delete existing;
+        return;
+    }
+
+    // 列表只显示名称和价格，不读取（可能压缩的）描述和图片
+    Product product = Product::getListRowFromDB(db, event.productId);
+    if (product.getProductId() == -1) {
+        productItems.remove(event.productId);
+        delete existing;
+        return;
+    }
+    QString productInfo = formatProductInfo(product.getName(), product.getPrice());
+    if (existing) {
+        existing->setText(productInfo);
+        existing->setData(Qt::UserRole + 1, product.getName());
+    } else {
+        addProductItem(event.productId, product.getName(), productInfo);
+    }
+}
+
+// 在状态栏显示选中商品的“买了又买”，名称取自已加载的列表项，不访问数据库
+void MainWindow::showRecommendations(QListWidgetItem *item)
+{
+    if (!item) {
+        statusBar()->clearMessage();
+        return;
+    }
+    QStringList names;
+    for (const Recommendation &rec : recommender.recommendationsFor(item->data(Qt::UserRole).toInt())) {
+        if (QListWidgetItem *other = productItems.value(rec.productId, nullptr)) {
+            names << other->data(Qt::UserRole + 1).toString();
+        }
+    }
+    if (names.isEmpty()) {
+        statusBar()->clearMessage();
+    } else {
+        statusBar()->showMessage("Customers also bought: " + names.join(", "));
+    }
+}
+
+// 建议名称取自已加载的列表项，不访问数据库
+void MainWindow::updateSearchSuggestions(const QString &text)
 {
-    QSqlQuery query(db);
-    query.exec("SELECT * FROM Products");
+    suggestionModel->clear();
+    if (text.trimmed().isEmpty()) {
+        return;
+    }
+    for (const Suggestion &suggestion : typeahead.complete(text)) {
+        if (QListWidgetItem *item = productItems.value(suggestion.productId, nullptr)) {
+            QStandardItem *row = new QStandardItem(item->data(Qt::UserRole + 1).toString());
+            row->setData(suggestion.productId, Qt::UserRole);
+            suggestionModel->appendRow(row);
+        }
+    }
+    searchCompleter->complete();
+}
 
+void MainWindow::loadProducts()
+{
     // 清除现有商品列表
     ui->productListWidget->clear();
+    productItems.clear();
 
-    // 遍历查询结果并添加到商品列表中
-    while (query.next()) {
-        QString productName = query.value("name").toString();
-        QString productDescription = query.value("description").toString();
-        float productPrice = query.value("price").toFloat();
+    // 只查询列表需要的列，并添加到商品列表中
+    for (const Product &product : Product::listProducts(db)) {
+        addProductItem(product.getProductId(), product.getName(),
+                       formatProductInfo(product.getName(), product.getPrice()));
+    }
+    productsLoaded = true;
+}
 
-        QString productInfo = QString("Name: %1\nDescription: %2\nPrice: $%3")
-                                  .arg(productName)
-                                  .arg(productDescription)
-                                  .arg(productPrice);
-        ui->productListWidget->addItem(productInfo);
+// 双击商品时显示详情（此时才读取并解压描述）
+void MainWindow::showProductDetails(QListWidgetItem *item)
+{
+    if (!item) {
+        return;
+    }
+    Product product = Product::getProductFromDB(db, item->data(Qt::UserRole).toInt());
+    if (product.getProductId() == -1) {
+        return;
     }
+    QMessageBox::information(this, product.getName(),
+                             QString("Description: %1\nPrice: $%2\nImage: %3")
+                                 .arg(product.getDescription())
+                                 .arg(product.getPrice())
+                                 .arg(product.getImage()));
 }
 // 当点击登录按钮时触发
 void MainWindow::on_loginButton_clicked()
@@ -169,7 +262,17 @@ void MainWindow::on_registerButton_clicked()
 
 
     // 调用 User::registerUser() 进行注册
-    if (currentUser) currentUser->registerUser(db);
+    RegistrationResult result = currentUser->registerUser(db);
+    if (result == RegistrationResult::UsernameTaken) {
+        currentUser.reset();
+        QMessageBox::warning(this, "Registration Failed", "Username \"" + username + "\" is already taken.");
+        return;
+    }
+    if (result == RegistrationResult::Failed) {
+        currentUser.reset();
+        QMessageBox::warning(this, "Registration Failed", "Could not register the user. Please try again.");
+        return;
+    }
 
     QMessageBox::information(this, "Registration", "User registered successfully!");
 }
@@ -3,11 +3,23 @@
 
 #include <QMainWindow>
 #include <QSqlDatabase>
+#include <QHash>
+#include <QCompleter>
+#include <QStandardItemModel>
 #include <memory>
 #include "core/user.h"
 #include "core/customer.h"
 #include "core/merchant.h"
 #include "core/product.h"
+#include "core/changefeed.h"
+#include "core/recommender.h"
+#include "core/productremover.h"
+#include "core/backupservice.h"
+#include "core/repricer.h"
+#include "core/eventjournal.h"
+#include "core/typeahead.h"
+
+class QListWidgetItem;
 
 namespace Ui {
 class MainWindow;
@@ -30,7 +42,23 @@ private:
     Ui::MainWindow *ui;  // GUI 组件
     QSqlDatabase db;     // 数据库连接
     std::unique_ptr<User> currentUser;    // 当前登录的用户
+    int changeFeedToken;  // ChangeFeed 订阅 token
+    QHash<int, QListWidgetItem *> productItems;  // productId -> 列表项
+    bool productsLoaded = false;                  // loadProducts() 之后才增量维护列表
+    CoPurchaseRecommender recommender;           // “买了又买”推荐（内存表）
+    std::unique_ptr<IncrementalVacuumScheduler> vacuumScheduler;  // 空闲时逐步回收空间
+    std::unique_ptr<BackupService> backupService;                 // 定时在线备份
+    std::unique_ptr<CampaignScheduler> campaignScheduler;         // 后台定时开始/结束价格活动
+    std::shared_ptr<EventJournal> journal;                        // 登录/上架/下架/下单事件日志
+    ProductTypeahead typeahead;                                   // 搜索框前缀补全
+    QCompleter *searchCompleter;
+    QStandardItemModel *suggestionModel;
     void loadProducts();
+    void addProductItem(int productId, const QString &productName, const QString &productInfo);
+    void showRecommendations(QListWidgetItem *item);
+    void updateSearchSuggestions(const QString &text);
+    void showProductDetails(QListWidgetItem *item);
+    void applyProductChange(const ChangeEvent &event);  // 按变更事件增量更新商品列表
 };
 
 #endif // MAINWINDOW_H
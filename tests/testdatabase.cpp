@@ -0,0 +1,169 @@
+#include "testdatabase.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QDebug>
+
+#include "core/schema.h"
+#include "core/user.h"
+
+// 当前生产 schema 的签名：在内存库中建表后对 sqlite_master 取哈希
+QString TestDatabaseFactory::schemaSignature() {
+    static QString signature;
+    if (!signature.isEmpty()) {
+        return signature;
+    }
+    const QString connection = "fixture_schema";
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+        db.setDatabaseName(":memory:");
+        db.open();
+        createTables(db);
+        QSqlQuery query(db);
+        query.exec("SELECT sql FROM sqlite_master WHERE sql IS NOT NULL ORDER BY name");
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        while (query.next()) {
+            hash.addData(query.value(0).toString().toUtf8());
+        }
+        signature = hash.result().toHex().left(12);
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connection);
+    return signature;
+}
+
+bool TestDatabaseFactory::buildTemplate(const QString &path, const SeedSpec &spec) {
+    const QString connection = "fixture_template";
+    bool ok = true;
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connection);
+        db.setDatabaseName(path);
+        if (!db.open()) {
+            qCritical() << "Failed to create fixture template:" << db.lastError().text();
+            return false;
+        }
+        createTables(db);
+
+        QRandomGenerator random(42);  // 固定种子，数据可复现
+        db.transaction();
+        QSqlQuery query(db);
+
+        // 用户：真实盐值与完整轮数的哈希
+        query.prepare("INSERT INTO Users (userId, username, password, salt, email, role) "
+                      "VALUES (:userId, :username, :password, :salt, :email, :role)");
+        for (int i = 1; i <= spec.users; ++i) {
+            QString salt = User::generateSalt();
+            query.bindValue(":userId", i);
+            query.bindValue(":username", seededUsername(i));
+            query.bindValue(":password", User::hashPassword(seededPassword(i), salt));
+            query.bindValue(":salt", salt);
+            query.bindValue(":email", seededUsername(i) + "@example.com");
+            query.bindValue(":role", (i % 2 == 0) ? "merchant" : "customer");
+            ok = ok && query.exec();
+        }
+
+        // 商品：归属于偶数号（merchant）用户
+        int merchants = spec.users / 2;
+        query.prepare("INSERT INTO Products (productId, name, description, price, image, merchantId) "
+                      "VALUES (:productId, :name, :description, :price, :image, :merchantId)");
+        for (int i = 1; i <= spec.products; ++i) {
+            query.bindValue(":productId", i);
+            query.bindValue(":name", QString("Product %1").arg(i, 6, 10, QChar('0')));
+            query.bindValue(":description", QString("Seeded product number %1").arg(i));
+            query.bindValue(":price", random.bounded(1, 100000) / 100.0);
+            query.bindValue(":image", QString("img/%1.png").arg(i));
+            query.bindValue(":merchantId", merchants > 0 ? QVariant(2 * (1 + random.bounded(merchants))) : QVariant());
+            ok = ok && query.exec();
+        }
+
+        // 订单：奇数号（customer）用户随机下单
+        query.prepare("INSERT INTO Orders (customerId, productId, quantity, orderDate) "
+                      "VALUES (:customerId, :productId, :quantity, :orderDate)");
+        for (int customer = 1; customer <= spec.users && spec.products > 0; customer += 2) {
+            for (int n = 0; n < spec.ordersPerCustomer; ++n) {
+                query.bindValue(":customerId", customer);
+                query.bindValue(":productId", 1 + random.bounded(spec.products));
+                query.bindValue(":quantity", 1 + random.bounded(5));
+                query.bindValue(":orderDate", QString("2024-%1-%2")
+                                                  .arg(1 + random.bounded(12), 2, 10, QChar('0'))
+                                                  .arg(1 + random.bounded(28), 2, 10, QChar('0')));
+                ok = ok && query.exec();
+            }
+        }
+
+        if (!ok) {
+            qCritical() << "Failed to seed fixture template:" << query.lastError().text();
+            db.rollback();
+        } else {
+            ok = db.commit();
+        }
+        query.finish();
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connection);
+    return ok;
+}
+
+QString TestDatabaseFactory::templatePath(const SeedSpec &spec) {
+    QString path = QDir(QDir::tempPath()).filePath(
+        QString("ShopLinkFixture-%1-v%2-%3-i%4-p%5-u%6-o%7.db")
+            .arg(schemaSignature())
+            .arg(SEED_FORMAT_VERSION)
+            .arg(QLatin1String(User::HASH_ALGORITHM))
+            .arg(User::DEFAULT_PBKDF2_ITERATIONS)
+            .arg(spec.products)
+            .arg(spec.users)
+            .arg(spec.ordersPerCustomer));
+    if (QFile::exists(path)) {
+        return path;
+    }
+
+    // 先写到进程私有的临时文件再改名，多个测试进程并发构建时不会读到半成品
+    QString staging = path + QString(".%1.tmp").arg(QCoreApplication::applicationPid());
+    QFile::remove(staging);
+    if (!buildTemplate(staging, spec)) {
+        QFile::remove(staging);
+        return QString();
+    }
+    if (!QFile::rename(staging, path)) {
+        QFile::remove(staging);  // 其他进程已先完成
+    }
+    return path;
+}
+
+static QString clonePath(const QString &connectionName) {
+    return QDir(QDir::tempPath()).filePath(
+        QString("ShopLinkClone-%1-%2.db").arg(QCoreApplication::applicationPid()).arg(connectionName));
+}
+
+QSqlDatabase TestDatabaseFactory::openClone(const QString &connectionName, const SeedSpec &spec) {
+    QString source = templatePath(spec);
+    QString target = clonePath(connectionName);
+    QFile::remove(target);
+    if (source.isEmpty() || !QFile::copy(source, target)) {
+        qCritical() << "Failed to clone fixture template into" << target;
+        return QSqlDatabase();
+    }
+    QFile::setPermissions(target, QFile::ReadOwner | QFile::WriteOwner);
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(target);
+    if (!db.open()) {
+        qCritical() << "Failed to open fixture clone:" << db.lastError().text();
+    }
+    return db;
+}
+
+void TestDatabaseFactory::closeClone(const QString &connectionName) {
+    {
+        QSqlDatabase db = QSqlDatabase::database(connectionName, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+    QFile::remove(clonePath(connectionName));
+}
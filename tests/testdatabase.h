@@ -0,0 +1,41 @@
+#ifndef TESTDATABASE_H
+#define TESTDATABASE_H
+
+#include <QString>
+#include <QSqlDatabase>
+
+// 种子数据规模
+struct SeedSpec {
+    int products = 100000;
+    int users = 50;           // 一半 customer，一半 merchant，密码使用真实的 PBKDF2 轮数
+    int ordersPerCustomer = 20;
+};
+
+// 大数据量测试夹具工厂。
+// 按生产 schema（core/schema）构建一次带种子数据的模板库，缓存在临时目录中，
+// 文件名包含 schema 签名、种子格式版本、密码哈希参数与种子规模，任一变化后自动重建；ctest 每个用例单独起进程，
+// 因此跨进程复用模板。每个测试拿到的是模板的私有拷贝（文件复制，毫秒级），互不影响。
+class TestDatabaseFactory {
+public:
+    // buildTemplate() 写入的数据内容或格式变化时递增，使旧模板失效
+    static const int SEED_FORMAT_VERSION = 2;
+
+    // 模板库路径（不存在则构建）
+    static QString templatePath(const SeedSpec &spec = SeedSpec());
+
+    // 克隆模板并以 connectionName 打开
+    static QSqlDatabase openClone(const QString &connectionName, const SeedSpec &spec = SeedSpec());
+
+    // 关闭并删除克隆
+    static void closeClone(const QString &connectionName);
+
+    // 第 i 个种子用户的用户名与明文密码
+    static QString seededUsername(int i) { return QString("user%1").arg(i); }
+    static QString seededPassword(int i) { return QString("password%1").arg(i); }
+
+private:
+    static QString schemaSignature();
+    static bool buildTemplate(const QString &path, const SeedSpec &spec);
+};
+
+#endif // TESTDATABASE_H
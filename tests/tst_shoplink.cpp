@@ -4,12 +4,39 @@
 #include <QSqlError>
 #include <QDebug>
 #include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+#include <QDataStream>
+#include <QRegularExpression>
+#include <QSettings>
 #include <string>
+#include <thread>
+#include <tuple>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
 
 // 引入被测头文件
 #include "core/customer.h"
 #include "core/merchant.h"
 #include "core/product.h"
+#include "core/changefeed.h"
+#include "core/orderexporter.h"
+#include "core/recommender.h"
+#include "core/productranker.h"
+#include "core/productremover.h"
+#include "core/schema.h"
+#include "core/shardrouter.h"
+#include "core/backupservice.h"
+#include "core/repricer.h"
+#include "core/eventjournal.h"
+#include "core/hotqueries.h"
+#include "core/typeahead.h"
+#include "core/userimporter.h"
+#include "testdatabase.h"
 
 // --- 测试夹具 (Test Fixture) ---
 // 用于在每个测试开始前建立数据库连接，结束后关闭
@@ -26,33 +53,16 @@ protected:
             qCritical() << "Failed to open memory database for testing";
             return;
         }
-        createTables();
+        // 与生产环境相同的 schema（含索引与用户名唯一约束）
+        ::createTables(db);
+        // 旧版遗留的 Sales 表（Merchant::viewSalesData 读取），生产 schema 不再创建
+        QSqlQuery query(db);
+        query.exec("CREATE TABLE Sales (saleId INTEGER PRIMARY KEY AUTOINCREMENT, productName TEXT, quantity INTEGER)");
     }
 
     void TearDown() override {
         db.close();
     }
-
-    // 辅助函数：创建表结构 (复制自 mainwindow.cpp 的逻辑)
-    void createTables() {
-        QSqlQuery query(db);
-        query.exec("CREATE TABLE Users ("
-                   "userId INTEGER PRIMARY KEY AUTOINCREMENT, "
-                   "username TEXT NOT NULL, "
-                   "password TEXT NOT NULL, "
-                   "salt TEXT NOT NULL, "
-                   "email TEXT NOT NULL, "
-                   "role TEXT NOT NULL)");
-
-        query.exec("CREATE TABLE Products ("
-                   "productId INTEGER PRIMARY KEY AUTOINCREMENT, "
-                   "name TEXT NOT NULL, "
-                   "description TEXT, "
-                   "price REAL NOT NULL, "
-                   "image TEXT)");
-
-        query.exec("CREATE TABLE Sales (saleId INTEGER PRIMARY KEY AUTOINCREMENT, productName TEXT, quantity INTEGER)");
-    }
 };
 
 // ========================================================
@@ -114,6 +124,30 @@ TEST_F(ShopLinkTest, MerchantRegistrationAndLogin) {
     EXPECT_TRUE(merchant.login(db, "admin888"));
 }
 
+// 用户名已被占用时注册失败，原账号不受影响
+TEST_F(ShopLinkTest, RegisteringTakenUsernameFails) {
+    Customer customer(0, "taken", "pw-1", "t1@mail.com");
+    ASSERT_EQ(customer.registerUser(db), RegistrationResult::Registered);
+    Customer again(0, "taken", "pw-2", "t2@mail.com");
+    EXPECT_EQ(again.registerUser(db), RegistrationResult::UsernameTaken);
+    EXPECT_TRUE(customer.login(db, "pw-1"));
+    EXPECT_FALSE(again.login(db, "pw-2"));
+}
+
+// 登录成功后 userId 应取自数据库
+TEST_F(ShopLinkTest, LoginLoadsUserIdFromDatabase) {
+    Merchant registered(0, "owner", "pw", "o@shop.com");
+    registered.registerUser(db);
+
+    QSqlQuery query(db);
+    query.exec("SELECT userId FROM Users WHERE username='owner'");
+    ASSERT_TRUE(query.next());
+
+    Merchant loggedIn(0, "owner", "pw", "");
+    ASSERT_TRUE(loggedIn.login(db, "pw"));
+    EXPECT_EQ(loggedIn.getUserId(), query.value(0).toInt());
+}
+
 // ========================================================
 // 子功能 2: 产品管理测试 (Product)
 // ========================================================
@@ -183,11 +217,13 @@ TEST_F(ShopLinkTest, PublishProductWithTruncatedDescription) {
 
     m.publishProduct(db, p);
 
+    // 截断后的描述超过压缩阈值，存于 descriptionZ，通过 getProductFromDB 读取
     QSqlQuery q(db);
-    q.exec("SELECT description FROM Products WHERE name='Huge'");
+    q.exec("SELECT productId FROM Products WHERE name='Huge'");
     ASSERT_TRUE(q.next());
-    QString stored = q.value("description").toString();
+    QString stored = Product::getProductFromDB(db, q.value(0).toInt()).getDescription();
     EXPECT_LE(stored.size(), 1024);
+    EXPECT_FALSE(stored.isEmpty());
 }
 
 // 测试用例 9: 商家发布产品 (集成测试)
@@ -247,6 +283,1235 @@ TEST_F(ShopLinkTest, DisplayProductInfo) {
 }
 
 
+// 长描述压缩存储，读取时透明解压
+TEST_F(ShopLinkTest, LongDescriptionStoredCompressed) {
+    QString longDesc = QString("Lorem ipsum dolor sit amet. ").repeated(100);
+    Product p(0, "Book", longDesc, 20.0, "book.png");
+    p.insertProductToDB(db);
+
+    QSqlQuery q(db);
+    q.exec("SELECT productId, description, descriptionZ FROM Products WHERE name='Book'");
+    ASSERT_TRUE(q.next());
+    EXPECT_TRUE(q.value("description").isNull());
+    EXPECT_LT(q.value("descriptionZ").toByteArray().size(), longDesc.size());
+
+    Product fetched = Product::getProductFromDB(db, q.value("productId").toInt());
+    EXPECT_EQ(fetched.getDescription(), longDesc);
+}
+
+// 列表查询不读取描述，首次访问时才加载
+TEST_F(ShopLinkTest, ListProductsLoadsDescriptionLazily) {
+    Product(0, "Pen", "Blue ink", 1.5, "pen.png").insertProductToDB(db);
+
+    QList<Product> products = Product::listProducts(db);
+    ASSERT_EQ(products.size(), 1);
+    EXPECT_EQ(products[0].getName(), "Pen");
+    EXPECT_FLOAT_EQ(products[0].getPrice(), 1.5);
+
+    // 在首次访问前修改库中描述，证明描述是延迟读取的
+    QSqlQuery q(db);
+    q.exec("UPDATE Products SET description = 'Black ink'");
+    EXPECT_EQ(products[0].getDescription(), "Black ink");
+    EXPECT_EQ(products[0].getImage(), "pen.png");
+}
+
+// 列表增量刷新只取列表行，描述同样延迟读取
+TEST_F(ShopLinkTest, ListRowLoadsDescriptionLazily) {
+    int id = Product(0, "Ink", "Red", 2.5, "ink.png").insertProductToDB(db);
+
+    Product row = Product::getListRowFromDB(db, id);
+    EXPECT_EQ(row.getProductId(), id);
+    EXPECT_EQ(row.getName(), "Ink");
+    EXPECT_FLOAT_EQ(row.getPrice(), 2.5);
+
+    QSqlQuery q(db);
+    q.exec("UPDATE Products SET description = 'Green'");
+    EXPECT_EQ(row.getDescription(), "Green");
+    EXPECT_EQ(Product::getListRowFromDB(db, id + 1).getProductId(), -1);
+}
+
+// ========================================================
+// 子功能 3: 变更广播测试 (ChangeFeed)
+// ========================================================
+
+// 发布与删除商品时应收到对应的增量事件
+TEST_F(ShopLinkTest, ChangeFeedPublishesInsertAndDelete) {
+    QList<ChangeEvent> events;
+    int token = ChangeFeed::instance().subscribe([&events](const ChangeEvent &e) { events.append(e); });
+
+    Merchant m(0, "seller", "pass", "s@s.com");
+    m.publishProduct(db, Product(0, "Feed", "Item", 1.0, "f.png"));
+    ASSERT_EQ(events.size(), 1);
+    EXPECT_EQ(events[0].type, ChangeType::Insert);
+    int id = events[0].productId;
+    EXPECT_EQ(Product::getProductFromDB(db, id).getName(), "Feed");
+
+    m.removeProduct(db, id);
+    ASSERT_EQ(events.size(), 2);
+    EXPECT_EQ(events[1].type, ChangeType::Delete);
+    EXPECT_EQ(events[1].productId, id);
+
+    ChangeFeed::instance().unsubscribe(token);
+}
+
+// 删除不存在的商品不应产生事件；退订后不再收到事件
+TEST_F(ShopLinkTest, ChangeFeedSkipsNoOpsAndUnsubscribed) {
+    int count = 0;
+    int token = ChangeFeed::instance().subscribe([&count](const ChangeEvent &) { ++count; });
+
+    Product::deleteProductFromDB(db, 9999);
+    EXPECT_EQ(count, 0);
+
+    ChangeFeed::instance().unsubscribe(token);
+    Product(0, "Quiet", "Item", 1.0, "q.png").insertProductToDB(db);
+    EXPECT_EQ(count, 0);
+}
+
+// ========================================================
+// 子功能 4: 订单/销售导出测试 (OrderExporter)
+// ========================================================
+
+class OrderExportTest : public ShopLinkTest {
+protected:
+    QTemporaryDir dir;
+
+    void SetUp() override {
+        ShopLinkTest::SetUp();
+        QSqlQuery q(db);
+        q.exec("INSERT INTO Products (productId, name, price, merchantId) VALUES (1, 'Pen, blue', 2.0, 7)");
+        q.exec("INSERT INTO Products (productId, name, price, merchantId) VALUES (2, 'Ink', 5.0, 7)");
+        q.exec("INSERT INTO Products (productId, name, price, merchantId) VALUES (3, 'Other', 9.0, 8)");
+        q.exec("INSERT INTO Orders (customerId, productId, quantity, orderDate) VALUES (1, 1, 3, '2024-01-05')");
+        q.exec("INSERT INTO Orders (customerId, productId, quantity, orderDate) VALUES (1, 2, 1, '2024-02-10')");
+        q.exec("INSERT INTO Orders (customerId, productId, quantity, orderDate) VALUES (2, 1, 2, '2024-03-01')");
+        q.exec("INSERT INTO Orders (customerId, productId, quantity, orderDate) VALUES (2, 3, 4, '2024-01-20')");
+    }
+
+    QStringList readLines(const QString &path) {
+        QFile f(path);
+        f.open(QIODevice::ReadOnly);
+        return QString::fromUtf8(f.readAll()).split('\n', Qt::SkipEmptyParts);
+    }
+};
+
+TEST_F(OrderExportTest, CsvOrdersFilteredByMerchantAndDate) {
+    ExportFilter filter;
+    filter.merchantId = 7;
+    filter.fromDate = "2024-01-01";
+    filter.toDate = "2024-03-01";
+
+    OrderExporter exporter(db, 1);
+    QString path = dir.filePath("orders.csv");
+    ASSERT_TRUE(exporter.exportOrders(path, filter, ExportFormat::Csv));
+    EXPECT_EQ(exporter.rowsExported(), 2);
+
+    QStringList lines = readLines(path);
+    ASSERT_EQ(lines.size(), 3);
+    EXPECT_EQ(lines[0], "orderId,customerId,productId,productName,quantity,orderDate");
+    EXPECT_EQ(lines[1], "1,1,1,\"Pen, blue\",3,2024-01-05");
+    EXPECT_EQ(lines[2], "2,1,2,Ink,1,2024-02-10");
+}
+
+TEST_F(OrderExportTest, SalesSummaryAggregatesPerProduct) {
+    Merchant merchant(7, "m7", "pw", "m7@shop.com");
+    QString path = dir.filePath("sales.csv");
+    ASSERT_TRUE(merchant.exportSalesData(db, path, ExportFilter()));
+
+    QStringList lines = readLines(path);
+    ASSERT_EQ(lines.size(), 3);
+    EXPECT_EQ(lines[1], "1,\"Pen, blue\",2,5,10");
+    EXPECT_EQ(lines[2], "2,Ink,1,1,5");
+}
+
+// 订单记下成交时的商家与单价：之后改价、下架都不改变该商家的导出结果
+TEST_F(OrderExportTest, SalesUseMerchantAndPriceAtPurchaseTime) {
+    QSqlQuery q(db);
+    q.exec("INSERT INTO Products (productId, name, price, merchantId) VALUES (4, 'Cap', 4.0, 7)");
+    Customer buyer(9, "buyer", "pw", "b@shop.com");
+    buyer.purchaseProduct(db, 4);
+    q.exec("UPDATE Products SET price = 100.0 WHERE productId = 4");
+    Product::deleteProductFromDB(db, 4);
+
+    ExportFilter filter;
+    filter.merchantId = 7;
+    OrderExporter exporter(db);
+    QString path = dir.filePath("sales.csv");
+    ASSERT_TRUE(exporter.exportSalesSummary(path, filter, ExportFormat::Csv));
+    QStringList lines = readLines(path);
+    ASSERT_EQ(lines.size(), 4);
+    EXPECT_EQ(lines[3], "4,,1,1,4");
+
+    // 旧订单没有这两列时按商品表的当前价格计算
+    q.exec("UPDATE Products SET price = 3.0 WHERE productId = 2");
+    ASSERT_TRUE(exporter.exportSalesSummary(path, filter, ExportFormat::Csv));
+    EXPECT_EQ(readLines(path)[2], "2,Ink,1,1,3");
+}
+
+// 没有 userId 的商家不能导出（否则等同于不过滤商家）
+TEST_F(OrderExportTest, SalesExportRequiresMerchantId) {
+    Merchant anonymous(0, "nobody", "pw", "");
+    QString path = dir.filePath("all.csv");
+    EXPECT_FALSE(anonymous.exportSalesData(db, path, ExportFilter()));
+    EXPECT_FALSE(QFile::exists(path));
+}
+
+// 读取中途出错（这里用 SUM 整数溢出模拟）时导出失败，不留下截断的文件
+TEST_F(OrderExportTest, ReadErrorMidStreamFailsExport) {
+    QSqlQuery q(db);
+    q.exec("INSERT INTO Orders (customerId, productId, quantity, orderDate) "
+           "VALUES (3, 3, 9223372036854775807, '2024-04-01'), (3, 3, 9223372036854775807, '2024-04-02')");
+
+    OrderExporter exporter(db);
+    QString path = dir.filePath("summary.csv");
+    EXPECT_FALSE(exporter.exportSalesSummary(path, ExportFilter(), ExportFormat::Csv));
+    EXPECT_FALSE(exporter.lastError().isEmpty());
+    EXPECT_FALSE(QFile::exists(path));
+}
+
+TEST_F(OrderExportTest, ColumnChunkedRoundTrip) {
+    OrderExporter exporter(db, 3);
+    QString path = dir.filePath("orders.bin");
+    ASSERT_TRUE(exporter.exportOrders(path, ExportFilter(), ExportFormat::ColumnChunked));
+    EXPECT_EQ(exporter.rowsExported(), 4);
+
+    QFile f(path);
+    ASSERT_TRUE(f.open(QIODevice::ReadOnly));
+    QDataStream in(&f);
+    char magic[4];
+    in.readRawData(magic, 4);
+    EXPECT_EQ(QByteArray(magic, 4), "SLCX");
+    quint16 version;
+    QStringList columns;
+    in >> version >> columns;
+    EXPECT_EQ(columns.size(), 6);
+
+    QVariantList orderIds;
+    int chunks = 0;
+    quint32 rows;
+    while (true) {
+        in >> rows;
+        if (rows == 0) break;
+        ++chunks;
+        for (int c = 0; c < columns.size(); ++c) {
+            QByteArray packed;
+            in >> packed;
+            QByteArray raw = qUncompress(packed);
+            QDataStream columnStream(raw);
+            QVariantList values;
+            columnStream >> values;
+            EXPECT_EQ(values.size(), static_cast<int>(rows));
+            if (c == 0) orderIds += values;
+        }
+    }
+    EXPECT_EQ(chunks, 2);
+    ASSERT_EQ(orderIds.size(), 4);
+    EXPECT_EQ(orderIds[3].toInt(), 4);
+}
+
+// ========================================================
+// 子功能 5: “买了又买”推荐测试 (CoPurchaseRecommender)
+// ========================================================
+
+TEST_F(ShopLinkTest, RecommenderBuildsTopKFromOrders) {
+    QSqlQuery q(db);
+    // 顾客 1: {1,2,3}，顾客 2: {1,2}，顾客 3: {1,3,3}
+    q.exec("INSERT INTO Orders (customerId, productId, quantity, orderDate) VALUES "
+           "(1,1,1,'d'),(1,2,1,'d'),(1,3,1,'d'),(2,1,1,'d'),(2,2,1,'d'),(3,1,1,'d'),(3,3,1,'d'),(3,3,1,'d')");
+
+    CoPurchaseRecommender recommender(1);
+    ASSERT_TRUE(recommender.build(db));
+
+    std::vector<Recommendation> forOne = recommender.recommendationsFor(1);
+    ASSERT_EQ(forOne.size(), 1u);
+    EXPECT_EQ(forOne[0].productId, 2);  // 与 3 同分，按 productId 决胜
+    EXPECT_EQ(forOne[0].score, 2);
+    EXPECT_TRUE(recommender.recommendationsFor(42).empty());
+}
+
+TEST_F(ShopLinkTest, RecommenderUpdatesIncrementallyOnCheckout) {
+    QSqlQuery q(db);
+    q.exec("INSERT INTO Products (productId, name, price) VALUES (1, 'Tea', 1.0), (2, 'Cup', 2.0)");
+
+    CoPurchaseRecommender recommender;
+    ASSERT_TRUE(recommender.build(db));
+    recommender.attach();
+
+    Customer buyer(5, "buyer", "pass", "b@mail.com");
+    buyer.purchaseProduct(db, 1);
+    buyer.purchaseProduct(db, 2);
+
+    q.exec("SELECT COUNT(*) FROM Orders WHERE customerId = 5");
+    ASSERT_TRUE(q.next());
+    EXPECT_EQ(q.value(0).toInt(), 2);
+
+    std::vector<Recommendation> forTea = recommender.recommendationsFor(1);
+    ASSERT_EQ(forTea.size(), 1u);
+    EXPECT_EQ(forTea[0].productId, 2);
+    EXPECT_EQ(forTea[0].score, 1);
+
+    Product::deleteProductFromDB(db, 2);
+    EXPECT_TRUE(recommender.recommendationsFor(1).empty());
+    EXPECT_TRUE(recommender.recommendationsFor(2).empty());
+
+    // 已删除的商品也从买家的购物篮中移除，之后的购买不再与它配对
+    q.exec("INSERT INTO Products (productId, name, price) VALUES (3, 'Pot', 3.0)");
+    buyer.purchaseProduct(db, 3);
+    std::vector<Recommendation> forPot = recommender.recommendationsFor(3);
+    ASSERT_EQ(forPot.size(), 1u);
+    EXPECT_EQ(forPot[0].productId, 1);
+}
+
+// ========================================================
+// 子功能 6: 商品排序测试 (ProductRanker)
+// ========================================================
+
+TEST_F(ShopLinkTest, RankerOrdersByCompositeKeys) {
+    QSqlQuery q(db);
+    q.exec("INSERT INTO Products (productId, name, price) VALUES "
+           "(1, 'banana', 3.0), (2, 'apple', 3.0), (3, 'cherry', 1.0), (4, 'fig', 5.0), (5, 'elder', 5.0)");
+    q.exec("INSERT INTO Orders (customerId, productId, quantity, orderDate) VALUES (1, 3, 5, 'd'), (1, 1, 2, 'd')");
+
+    ProductRanker ranker;
+    ASSERT_TRUE(ranker.load(db));
+    EXPECT_EQ(ranker.size(), 5);
+
+    // 价格升序，同价按名称
+    EXPECT_EQ(ranker.rank({{RankField::Price}, {RankField::Name}}), std::vector<int>({3, 2, 1, 5, 4}));
+    // 名称排序
+    EXPECT_EQ(ranker.rank({{RankField::Name}}), std::vector<int>({2, 1, 3, 5, 4}));
+    // 销量降序，同销量按最新
+    EXPECT_EQ(ranker.rank({{RankField::Popularity, true}, {RankField::Recency, true}}),
+              std::vector<int>({3, 1, 5, 4, 2}));
+    // 分页
+    EXPECT_EQ(ranker.rankPage({{RankField::Price}, {RankField::Name}}, 1, 2), std::vector<int>({2, 1}));
+    EXPECT_TRUE(ranker.rankPage({{RankField::Price}}, 10, 2).empty());
+}
+
+TEST_F(ShopLinkTest, RankerPageMatchesFullSortOnLargeCatalog) {
+    db.transaction();
+    QSqlQuery q(db);
+    q.prepare("INSERT INTO Products (name, price) VALUES (:name, :price)");
+    for (int i = 0; i < 50000; ++i) {
+        q.bindValue(":name", QString("p%1").arg(i));
+        q.bindValue(":price", static_cast<double>((i * 7919) % 1000));
+        q.exec();
+    }
+    db.commit();
+
+    ProductRanker ranker;
+    ASSERT_TRUE(ranker.load(db));
+    std::vector<SortKey> byPriceDesc = {{RankField::Price, true}};
+    std::vector<int> full = ranker.rank(byPriceDesc);
+    ASSERT_EQ(full.size(), 50000u);
+
+    std::vector<int> page = ranker.rankPage(byPriceDesc, 100, 50);
+    ASSERT_EQ(page.size(), 50u);
+    EXPECT_TRUE(std::equal(page.begin(), page.end(), full.begin() + 100));
+}
+
+// ========================================================
+// 子功能 7: 批量删除与增量 VACUUM 测试 (ProductRemover)
+// ========================================================
+
+TEST_F(ShopLinkTest, BulkRemoveDeletesInChunksAndPublishesEvents) {
+    db.transaction();
+    QSqlQuery q(db);
+    q.prepare("INSERT INTO Products (name, price) VALUES (:name, 1.0)");
+    for (int i = 0; i < 1200; ++i) {
+        q.bindValue(":name", QString("bulk%1").arg(i));
+        q.exec();
+    }
+    db.commit();
+
+    QList<int> ids;
+    for (int id = 1; id <= 1000; ++id) {
+        ids.append(id);
+    }
+    ids.append(99999);  // 不存在的 ID 不计数也不发事件
+
+    int deleteEvents = 0;
+    int token = ChangeFeed::instance().subscribe([&deleteEvents](const ChangeEvent &e) {
+        if (e.type == ChangeType::Delete) ++deleteEvents;
+    });
+    EXPECT_EQ(ProductRemover::removeProducts(db, ids, 300), 1000);
+    ChangeFeed::instance().unsubscribe(token);
+    EXPECT_EQ(deleteEvents, 1000);
+
+    q.exec("SELECT COUNT(*) FROM Products");
+    ASSERT_TRUE(q.next());
+    EXPECT_EQ(q.value(0).toInt(), 200);
+}
+
+TEST_F(ShopLinkTest, MerchantRemoveAllProductsOnlyTouchesOwnCatalog) {
+    QSqlQuery q(db);
+    q.exec("INSERT INTO Products (name, price, merchantId) VALUES ('a', 1, 3), ('b', 1, 3), ('c', 1, 4)");
+
+    Merchant merchant(3, "m3", "pw", "m3@shop.com");
+    EXPECT_EQ(merchant.removeAllProducts(db), 2);
+
+    q.exec("SELECT merchantId FROM Products");
+    ASSERT_TRUE(q.next());
+    EXPECT_EQ(q.value(0).toInt(), 4);
+    EXPECT_FALSE(q.next());
+}
+
+TEST(IncrementalVacuumTest, StepReclaimsFreePages) {
+    QTemporaryDir dir;
+    {
+        QSqlDatabase fileDb = QSqlDatabase::addDatabase("QSQLITE", "vacuum_test");
+        fileDb.setDatabaseName(dir.filePath("vacuum.db"));
+        ASSERT_TRUE(fileDb.open());
+        createTables(fileDb);
+
+        fileDb.transaction();
+        QSqlQuery q(fileDb);
+        q.prepare("INSERT INTO Products (name, description, price) VALUES ('x', :description, 1.0)");
+        for (int i = 0; i < 2000; ++i) {
+            q.bindValue(":description", QString(300, QChar('a' + i % 26)));
+            q.exec();
+        }
+        fileDb.commit();
+        q.exec("DELETE FROM Products");
+
+        IncrementalVacuumScheduler scheduler(fileDb, 16, 0);
+        int before = scheduler.freePages();
+        ASSERT_GT(before, 16);
+        EXPECT_EQ(scheduler.step(), 16);
+        EXPECT_EQ(scheduler.freePages(), before - 16);
+        q.finish();
+        fileDb.close();
+    }
+    QSqlDatabase::removeDatabase("vacuum_test");
+}
+
+// ========================================================
+// 子功能 8: 按商家分片测试 (ShardRouter)
+// ========================================================
+
+TEST(ShardRouterTest, RoutesMerchantsAndMergesCatalog) {
+    QTemporaryDir dir;
+    ShardRouter router(dir.path(), 4, "ShardTest");
+    ASSERT_TRUE(router.open());
+
+    for (int merchantId = 1; merchantId <= 8; ++merchantId) {
+        Merchant merchant(merchantId, QString("m%1").arg(merchantId), "pw", "");
+        merchant.publishProduct(router, Product(0, QString("item%1").arg(merchantId), QString("desc%1").arg(merchantId), 1.0, ""));
+    }
+
+    QList<Product> catalog = router.listCatalog();
+    ASSERT_EQ(catalog.size(), 8);
+    for (int i = 0; i < catalog.size(); ++i) {
+        const Product &p = catalog[i];
+        if (i > 0) {
+            EXPECT_LT(catalog[i - 1].getProductId(), p.getProductId());
+        }
+        // 商品所在分片与其商家的分片一致，且可仅凭 productId 定位
+        EXPECT_EQ(router.shardForProduct(p.getProductId()), router.shardForMerchant(p.getMerchantId()));
+        EXPECT_EQ(p.getDescription(), QString("desc%1").arg(p.getMerchantId()));
+        EXPECT_EQ(router.getProduct(p.getProductId()).getName(), p.getName());
+    }
+
+    // 订单写入商品所在分片
+    int productId = catalog[0].getProductId();
+    Customer buyer(100, "buyer", "pw", "");
+    buyer.purchaseProduct(router, productId);
+    QSqlQuery q(router.databaseForProduct(productId));
+    q.exec("SELECT orderId FROM Orders");
+    ASSERT_TRUE(q.next());
+    EXPECT_EQ(router.shardForProduct(q.value(0).toInt()), router.shardForProduct(productId));
+    q.finish();
+
+    // 删除按 productId 定位分片
+    Merchant owner(catalog[0].getMerchantId(), "owner", "pw", "");
+    owner.removeProduct(router, productId);
+    EXPECT_EQ(router.getProduct(productId).getProductId(), -1);
+    EXPECT_EQ(router.listCatalog().size(), 7);
+}
+
+// 商家 id 同奇偶（如种子库中全是偶数号商家）时也应分布到所有分片
+TEST(ShardRouterTest, EvenMerchantIdsSpreadOverAllShards) {
+    for (int shardCount : {2, 4, 8, 10}) {
+        ShardRouter router(QDir::tempPath(), shardCount, "ShardSpread");
+        std::vector<int> perShard(shardCount, 0);
+        const int merchants = 100;
+        for (int merchantId = 2; merchantId <= 2 * merchants; merchantId += 2) {
+            ++perShard[router.shardForMerchant(merchantId)];
+        }
+        for (int shard = 0; shard < shardCount; ++shard) {
+            EXPECT_GE(perShard[shard] * 2 * shardCount, merchants)
+                << "shard " << shard << " of " << shardCount << " got " << perShard[shard];
+        }
+    }
+}
+
+// ========================================================
+// 子功能 9: 在线备份测试 (BackupService)
+// ========================================================
+
+TEST(BackupServiceTest, SnapshotsAreConsistentAndRotated) {
+    QTemporaryDir dir;
+    QString source = dir.filePath("live.db");
+    {
+        QSqlDatabase live = QSqlDatabase::addDatabase("QSQLITE", "backup_live");
+        live.setDatabaseName(source);
+        ASSERT_TRUE(live.open());
+        createTables(live);
+        QSqlQuery q(live);
+        q.exec("INSERT INTO Products (name, price) VALUES ('Saved', 1.0)");
+
+        // 源库保持打开、继续写入的同时进行备份
+        BackupService backups(source, dir.filePath("backups"), 2);
+        QString first = backups.backupNow();
+        ASSERT_FALSE(first.isEmpty()) << backups.lastError().toStdString();
+        q.exec("INSERT INTO Products (name, price) VALUES ('Later', 2.0)");
+        ASSERT_FALSE(backups.backupNow().isEmpty());
+        QString last = backups.backupNow();
+        ASSERT_FALSE(last.isEmpty());
+
+        QStringList kept = backups.snapshots();
+        ASSERT_EQ(kept.size(), 2);
+        EXPECT_FALSE(kept.contains(first));
+        EXPECT_EQ(kept.last(), last);
+
+        {
+            QSqlDatabase snapshot = QSqlDatabase::addDatabase("QSQLITE", "backup_snapshot");
+            snapshot.setDatabaseName(last);
+            ASSERT_TRUE(snapshot.open());
+            QSqlQuery check(snapshot);
+            check.exec("SELECT COUNT(*) FROM Products");
+            ASSERT_TRUE(check.next());
+            EXPECT_EQ(check.value(0).toInt(), 2);
+            check.finish();
+            snapshot.close();
+        }
+        QSqlDatabase::removeDatabase("backup_snapshot");
+        q.finish();
+        live.close();
+    }
+    QSqlDatabase::removeDatabase("backup_live");
+}
+
+// ========================================================
+// 子功能 10: 批量调价与价格活动测试 (Repricer)
+// ========================================================
+
+// 使用生产 schema（core/schema）的夹具
+class CoreSchemaTest : public ::testing::Test {
+protected:
+    QSqlDatabase db;
+
+    void SetUp() override {
+        db = QSqlDatabase::addDatabase("QSQLITE", "core_schema");
+        db.setDatabaseName(":memory:");
+        ASSERT_TRUE(db.open());
+        createTables(db);
+    }
+
+    void TearDown() override {
+        db.close();
+        db = QSqlDatabase();
+        QSqlDatabase::removeDatabase("core_schema");
+    }
+
+    float priceOf(int productId) {
+        QSqlQuery q(db);
+        q.exec("SELECT price FROM Products WHERE productId = " + QString::number(productId));
+        return q.next() ? q.value(0).toFloat() : -1.0f;
+    }
+};
+
+TEST_F(CoreSchemaTest, RepriceSelectionInOneStatement) {
+    QSqlQuery q(db);
+    q.exec("INSERT INTO Products (productId, name, price, merchantId) VALUES "
+           "(1, 'a', 10.0, 1), (2, 'b', 20.0, 1), (3, 'c', 3.0, 2)");
+
+    int updates = 0;
+    int token = ChangeFeed::instance().subscribe([&updates](const ChangeEvent &e) {
+        if (e.type == ChangeType::Update) ++updates;
+    });
+
+    EXPECT_EQ(Repricer::apply(db, ProductSelection{{}, 1}, {PriceAdjustment::Percent, -10}), 2);
+    EXPECT_FLOAT_EQ(priceOf(1), 9.0f);
+    EXPECT_FLOAT_EQ(priceOf(2), 18.0f);
+    EXPECT_FLOAT_EQ(priceOf(3), 3.0f);
+    EXPECT_EQ(updates, 2);
+
+    // 价格不会降到 0 以下
+    EXPECT_EQ(Repricer::apply(db, ProductSelection{{3, 42}}, {PriceAdjustment::Absolute, -5}), 1);
+    EXPECT_FLOAT_EQ(priceOf(3), 0.0f);
+
+    EXPECT_EQ(Repricer::apply(db, ProductSelection(), {PriceAdjustment::Absolute, 1}), 3);
+    EXPECT_FLOAT_EQ(priceOf(1), 10.0f);
+    ChangeFeed::instance().unsubscribe(token);
+}
+
+// 大批量调价只发一条 Reload，而不是每个商品一条 Update
+TEST_F(CoreSchemaTest, BulkRepricePublishesSingleReload) {
+    QSqlQuery q(db);
+    db.transaction();
+    q.prepare("INSERT INTO Products (name, price) VALUES (?, 10.0)");
+    for (int i = 0; i <= Repricer::BULK_UPDATE_THRESHOLD; ++i) {
+        q.bindValue(0, QString("p%1").arg(i));
+        q.exec();
+    }
+    db.commit();
+
+    std::vector<ChangeEvent> received;
+    int token = ChangeFeed::instance().subscribe([&received](const ChangeEvent &e) { received.push_back(e); });
+    EXPECT_EQ(Repricer::apply(db, ProductSelection(), {PriceAdjustment::Percent, -10}),
+              Repricer::BULK_UPDATE_THRESHOLD + 1);
+    ChangeFeed::instance().unsubscribe(token);
+
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0].type, ChangeType::Reload);
+    EXPECT_FLOAT_EQ(priceOf(1), 9.0f);
+}
+
+TEST_F(CoreSchemaTest, PriceCampaignStartsAndReverts) {
+    QSqlQuery q(db);
+    q.exec("INSERT INTO Products (productId, name, price) VALUES (1, 'a', 10.0), (2, 'b', 20.0), (3, 'c', 30.0)");
+
+    QDateTime start(QDate(2030, 1, 1), QTime(0, 0), Qt::UTC);
+    QDateTime end(QDate(2030, 1, 2), QTime(0, 0), Qt::UTC);
+    int campaign = Repricer::scheduleCampaign(db, "New year", ProductSelection(),
+                                              {PriceAdjustment::Percent, -50}, start, end);
+    ASSERT_GT(campaign, 0);
+
+    EXPECT_EQ(Repricer::runDueCampaigns(db, start.addSecs(-60)), 0);
+    EXPECT_FLOAT_EQ(priceOf(1), 10.0f);
+
+    EXPECT_EQ(Repricer::runDueCampaigns(db, start.addSecs(60)), 1);
+    EXPECT_FLOAT_EQ(priceOf(1), 5.0f);
+    EXPECT_FLOAT_EQ(priceOf(2), 10.0f);
+
+    // 活动期间被单独改价的商品在活动结束时保留新价格
+    q.exec("UPDATE Products SET price = 12.0 WHERE productId = 2");
+
+    EXPECT_EQ(Repricer::runDueCampaigns(db, end.addSecs(60)), 1);
+    EXPECT_FLOAT_EQ(priceOf(1), 10.0f);
+    EXPECT_FLOAT_EQ(priceOf(2), 12.0f);
+    EXPECT_FLOAT_EQ(priceOf(3), 30.0f);
+    EXPECT_EQ(Repricer::runDueCampaigns(db, end.addSecs(120)), 0);
+}
+
+// 重叠的活动不叠加折扣，两者结束后价格都恢复
+TEST_F(CoreSchemaTest, OverlappingPriceCampaignsDoNotStack) {
+    QSqlQuery q(db);
+    q.exec("INSERT INTO Products (productId, name, price) VALUES (1, 'a', 10.0), (2, 'b', 20.0)");
+
+    QDateTime t0(QDate(2030, 1, 1), QTime(0, 0), Qt::UTC);
+    ASSERT_GT(Repricer::scheduleCampaign(db, "A", ProductSelection{{1}}, {PriceAdjustment::Absolute, -2},
+                                         t0, t0.addSecs(3600)), 0);
+    ASSERT_GT(Repricer::scheduleCampaign(db, "B", ProductSelection{{1, 2}}, {PriceAdjustment::Absolute, -2},
+                                         t0.addSecs(1800), t0.addSecs(7200)), 0);
+
+    EXPECT_EQ(Repricer::runDueCampaigns(db, t0.addSecs(60)), 1);
+    EXPECT_FLOAT_EQ(priceOf(1), 8.0f);
+    EXPECT_EQ(Repricer::runDueCampaigns(db, t0.addSecs(1860)), 1);
+    EXPECT_FLOAT_EQ(priceOf(1), 8.0f);   // 已在 A 中，B 不再叠加
+    EXPECT_FLOAT_EQ(priceOf(2), 18.0f);
+
+    EXPECT_EQ(Repricer::runDueCampaigns(db, t0.addSecs(3660)), 1);
+    EXPECT_FLOAT_EQ(priceOf(1), 10.0f);
+    EXPECT_EQ(Repricer::runDueCampaigns(db, t0.addSecs(7260)), 1);
+    EXPECT_FLOAT_EQ(priceOf(1), 10.0f);
+    EXPECT_FLOAT_EQ(priceOf(2), 20.0f);
+}
+
+TEST_F(CoreSchemaTest, MissedPriceCampaignIsNotApplied) {
+    QSqlQuery q(db);
+    q.exec("INSERT INTO Products (productId, name, price) VALUES (1, 'a', 10.0)");
+
+    QDateTime start(QDate(2030, 1, 1), QTime(0, 0), Qt::UTC);
+    ASSERT_GT(Repricer::scheduleCampaign(db, "Flash", ProductSelection{{1}}, {PriceAdjustment::Absolute, -1},
+                                         start, start.addSecs(3600)), 0);
+    EXPECT_EQ(Repricer::runDueCampaigns(db, start.addDays(1)), 1);
+    EXPECT_FLOAT_EQ(priceOf(1), 10.0f);
+}
+
+// 定时活动在后台线程自己的连接上执行，事件也在该线程发布
+TEST(CampaignSchedulerTest, RunsDueCampaignsOnWorkerThread) {
+    QTemporaryDir dir;
+    QString path = dir.filePath("campaigns.db");
+    QSqlDatabase live = QSqlDatabase::addDatabase("QSQLITE", "campaign_live");
+    live.setDatabaseName(path);
+    ASSERT_TRUE(live.open());
+    createTables(live);
+    QSqlQuery q(live);
+    q.exec("INSERT INTO Products (productId, name, price) VALUES (1, 'a', 10.0)");
+    QDateTime now = QDateTime::currentDateTimeUtc();
+    ASSERT_GT(Repricer::scheduleCampaign(live, "Now", ProductSelection{{1}}, {PriceAdjustment::Absolute, -1},
+                                         now.addSecs(-60), now.addSecs(3600)), 0);
+
+    std::atomic<bool> updated{false};
+    std::atomic<bool> onWorker{false};
+    std::thread::id mainThread = std::this_thread::get_id();
+    int token = ChangeFeed::instance().subscribe([&](const ChangeEvent &event) {
+        if (event.type == ChangeType::Update && event.productId == 1) {
+            onWorker = std::this_thread::get_id() != mainThread;
+            updated = true;
+        }
+    });
+    {
+        CampaignScheduler scheduler(path);
+        scheduler.start(60 * 1000);
+        for (int i = 0; i < 500 && !updated; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        scheduler.stop();
+    }
+    ChangeFeed::instance().unsubscribe(token);
+
+    EXPECT_TRUE(updated);
+    EXPECT_TRUE(onWorker);
+    q.exec("SELECT price FROM Products WHERE productId = 1");
+    ASSERT_TRUE(q.next());
+    EXPECT_FLOAT_EQ(q.value(0).toFloat(), 9.0f);
+    q.finish();
+    live.close();
+}
+
+// ========================================================
+// 子功能 11: 事件日志测试 (EventJournal)
+// ========================================================
+
+TEST(EventJournalTest, AppendAndReplayInOrder) {
+    QTemporaryDir dir;
+    {
+        EventJournal journal(dir.path());
+        ASSERT_TRUE(journal.open());
+        EXPECT_EQ(journal.append(JournalEventType::Login, "a"), 1u);
+        EXPECT_EQ(journal.append(JournalEventType::OrderPlaced, "b"), 2u);
+    }
+    {
+        // 重新打开后序号接着上次继续
+        EventJournal journal(dir.path());
+        ASSERT_TRUE(journal.open());
+        EXPECT_EQ(journal.append(JournalEventType::ProductRemoved, "c"), 3u);
+    }
+
+    JournalReader reader(dir.path());
+    JournalRecord record;
+    QByteArray payloads;
+    quint64 expected = 1;
+    while (reader.next(record)) {
+        EXPECT_EQ(record.sequence, expected++);
+        payloads += record.payload;
+    }
+    EXPECT_EQ(payloads, QByteArray("abc"));
+
+    JournalReader tail(dir.path(), 3);
+    ASSERT_TRUE(tail.next(record));
+    EXPECT_EQ(record.type, JournalEventType::ProductRemoved);
+    EXPECT_FALSE(tail.next(record));
+}
+
+TEST(EventJournalTest, ConcurrentAppendersGetUniqueSequences) {
+    QTemporaryDir dir;
+    EventJournal journal(dir.path(), 4096);  // 小段，顺带触发分段
+    ASSERT_TRUE(journal.open());
+
+    const int threads = 4, perThread = 50;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&journal, t]() {
+            for (int i = 0; i < perThread; ++i) {
+                journal.append(JournalEventType::OrderPlaced, QByteArray(200, 'x') + QByteArray::number(t * 1000 + i));
+            }
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    EXPECT_GT(journal.segmentFiles().size(), 1);
+
+    JournalReader reader(dir.path());
+    JournalRecord record;
+    quint64 expected = 1;
+    while (reader.next(record)) {
+        ASSERT_EQ(record.sequence, expected++);
+    }
+    EXPECT_EQ(expected - 1, static_cast<quint64>(threads * perThread));
+
+    // 只保留 1 个已写满的段，回放从保留段的第一条开始
+    int before = journal.segmentFiles().size();
+    EXPECT_EQ(journal.retainSegments(1), before - 2);
+    EXPECT_EQ(journal.segmentFiles().size(), 2);
+    JournalReader retained(dir.path());
+    ASSERT_TRUE(retained.next(record));
+    EXPECT_GT(record.sequence, 1u);
+}
+
+TEST(EventJournalTest, TornTailIsTruncatedOnOpen) {
+    QTemporaryDir dir;
+    QString segmentPath;
+    {
+        EventJournal journal(dir.path());
+        ASSERT_TRUE(journal.open());
+        journal.append(JournalEventType::Login, "first");
+        journal.append(JournalEventType::Login, "second");
+        segmentPath = journal.segmentFiles().last();
+    }
+    // 模拟写到一半崩溃：截掉最后一条记录的几个字节
+    {
+        QFile file(segmentPath);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        file.resize(file.size() - 3);
+    }
+
+    EventJournal journal(dir.path());
+    ASSERT_TRUE(journal.open());
+    EXPECT_EQ(journal.append(JournalEventType::Login, "third"), 2u);
+
+    JournalReader reader(dir.path());
+    JournalRecord record;
+    QList<QByteArray> payloads;
+    while (reader.next(record)) {
+        payloads << record.payload;
+    }
+    EXPECT_EQ(payloads, (QList<QByteArray>{"first", "third"}));
+}
+
+TEST(EventJournalTest, FailedRotationIsReportedAndRetried) {
+    QTemporaryDir dir;
+    EventJournal journal(dir.path(), 1);  // 每批都切到新段
+    ASSERT_TRUE(journal.open());
+    ASSERT_EQ(journal.append(JournalEventType::Login, "a"), 1u);
+    EXPECT_TRUE(journal.healthy());
+
+    // 用同名目录占住下一段的文件名，切段必然失败（root 下同样有效）
+    QString blocker = QDir(dir.path()).filePath("segment-00000000000000000002.log");
+    ASSERT_TRUE(QDir().mkpath(blocker));
+    EXPECT_EQ(journal.append(JournalEventType::Login, "b"), 0u);
+    EXPECT_FALSE(journal.healthy());
+    EXPECT_FALSE(journal.lastError().isEmpty());
+    EXPECT_EQ(journal.post(JournalEventType::Login, "c"), 3u);  // 出错期间继续排队，序号连续
+
+    // 故障排除后，close() 前的重试把积压的记录按原序号写入
+    ASSERT_TRUE(QDir(blocker).removeRecursively());
+    journal.close();
+    EXPECT_TRUE(journal.healthy());
+    EXPECT_EQ(journal.droppedRecords(), 0u);
+
+    JournalReader reader(dir.path());
+    JournalRecord record;
+    QByteArray payloads;
+    quint64 expected = 1;
+    while (reader.next(record)) {
+        EXPECT_EQ(record.sequence, expected++);
+        payloads += record.payload;
+    }
+    EXPECT_EQ(payloads, QByteArray("abc"));
+}
+
+TEST(EventJournalTest, RecordSurvivesConcurrentShutdown) {
+    QTemporaryDir dir;
+    auto journal = std::make_shared<EventJournal>(dir.path());
+    ASSERT_TRUE(journal->open());
+    EventJournal::setActive(journal);
+    std::weak_ptr<EventJournal> watch = journal;
+
+    std::atomic<bool> go{true};
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([&go, t]() {
+            for (int i = 0; go; ++i) {
+                EventJournal::record(JournalEventType::Login, {t, i});
+            }
+        });
+    }
+    // 关闭顺序与 MainWindow 析构一致：先摘掉活动日志再关闭，正在 record() 的线程仍持有引用
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EventJournal::setActive(nullptr);
+    journal->close();
+    journal.reset();
+    go = false;
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    EXPECT_TRUE(watch.expired());
+
+    // close() 之前入队的记录全部落盘，序号连续
+    JournalReader reader(dir.path());
+    JournalRecord record;
+    quint64 expected = 1;
+    while (reader.next(record)) {
+        ASSERT_EQ(record.sequence, expected++);
+    }
+    EXPECT_GT(expected, 1u);
+}
+
+TEST_F(CoreSchemaTest, BusinessEventsAreJournaled) {
+    QTemporaryDir dir;
+    auto journal = std::make_shared<EventJournal>(dir.path());
+    ASSERT_TRUE(journal->open());
+    EventJournal::setActive(journal);
+
+    Merchant merchant(7, "m", "p", "m@x.com");
+    merchant.publishProduct(db, Product(0, "Lamp", "Desk lamp", 20.0, "lamp.png"));
+    Customer customer(8, "c", "p", "c@x.com");
+    customer.purchaseProduct(db, 1);
+    merchant.removeProduct(db, 1);
+    EventJournal::setActive(nullptr);
+    journal->close();  // 等写线程把排队的记录写完
+
+    JournalReader reader(dir.path());
+    JournalRecord record;
+    QList<JournalEventType> types;
+    while (reader.next(record)) {
+        types << record.type;
+        if (record.type == JournalEventType::OrderPlaced) {
+            QVariantList fields = record.fields();
+            ASSERT_EQ(fields.size(), 3);
+            EXPECT_EQ(fields[0].toInt(), 1);
+            EXPECT_EQ(fields[1].toInt(), 8);
+        }
+    }
+    EXPECT_EQ(types, (QList<JournalEventType>{JournalEventType::ProductPublished, JournalEventType::OrderPlaced,
+                                              JournalEventType::ProductRemoved}));
+}
+
+TEST_F(CoreSchemaTest, BulkRemovalsAndRepricingAreJournaled) {
+    QTemporaryDir dir;
+    auto journal = std::make_shared<EventJournal>(dir.path());
+    ASSERT_TRUE(journal->open());
+    EventJournal::setActive(journal);
+
+    Merchant merchant(7, "m", "p", "m@x.com");
+    for (int i = 0; i < 3; ++i) {
+        merchant.publishProduct(db, Product(0, QString("Item %1").arg(i), "", 10.0, ""));
+    }
+    EXPECT_EQ(Repricer::apply(db, ProductSelection{{1, 2}}, {PriceAdjustment::Absolute, 1}), 2);
+    Product::deleteProductFromDB(db, 3);
+    merchant.removeAllProducts(db);
+    EventJournal::setActive(nullptr);
+    journal->close();  // 等写线程把排队的记录写完
+
+    JournalReader reader(dir.path());
+    JournalRecord record;
+    QList<JournalEventType> types;
+    while (reader.next(record)) {
+        if (record.type == JournalEventType::ProductPublished) {
+            continue;
+        }
+        types << record.type;
+        QVariantList fields = record.fields();
+        if (record.type == JournalEventType::PricesChanged) {
+            ASSERT_EQ(fields.size(), 3);
+            EXPECT_EQ(fields[0].toString(), QString("reprice"));
+            EXPECT_EQ(fields[2].toList(), (QVariantList{1, 2}));
+        } else if (record.type == JournalEventType::ProductRemoved) {
+            EXPECT_EQ(fields[0].toInt(), 3);
+        } else if (record.type == JournalEventType::ProductsRemoved) {
+            EXPECT_EQ(fields[0].toList(), (QVariantList{1, 2}));
+        }
+    }
+    EXPECT_EQ(types, (QList<JournalEventType>{JournalEventType::PricesChanged, JournalEventType::ProductRemoved,
+                                              JournalEventType::ProductsRemoved}));
+}
+
+// ========================================================
+// 子功能 12: 商品名前缀补全测试 (ProductTypeahead)
+// ========================================================
+
+static std::vector<int> suggestionIds(const std::vector<Suggestion> &suggestions) {
+    std::vector<int> ids;
+    for (const Suggestion &s : suggestions) {
+        ids.push_back(s.productId);
+    }
+    return ids;
+}
+
+TEST_F(CoreSchemaTest, TypeaheadRanksCompletionsByPopularity) {
+    QSqlQuery q(db);
+    q.exec("INSERT INTO Products (productId, name, price) VALUES "
+           "(1, 'Apple Juice', 3.0), (2, 'apple pie', 5.0), (3, 'Apricot', 2.0), (4, 'Banana', 1.0)");
+    q.exec("INSERT INTO Orders (customerId, productId, quantity, orderDate) VALUES "
+           "(9, 2, 3, '2030-01-01T00:00:00Z'), (9, 3, 1, '2030-01-01T00:00:00Z')");
+
+    ProductTypeahead typeahead;
+    ASSERT_TRUE(typeahead.build(db));
+    EXPECT_EQ(typeahead.size(), 4);
+
+    // 短前缀走预计算缓存，长前缀走范围扫描；大小写与多余空格不影响匹配
+    EXPECT_EQ(suggestionIds(typeahead.complete("a")), (std::vector<int>{2, 3, 1}));
+    EXPECT_EQ(suggestionIds(typeahead.complete("  APPLE ")), (std::vector<int>{2, 1}));
+    EXPECT_EQ(suggestionIds(typeahead.complete("apple  j")), (std::vector<int>{1}));
+    EXPECT_EQ(suggestionIds(typeahead.complete("a", 1)), (std::vector<int>{2}));
+    EXPECT_TRUE(typeahead.complete("cherry").empty());
+    EXPECT_EQ(typeahead.complete("ap").front().popularity, 3);
+}
+
+TEST_F(CoreSchemaTest, TypeaheadFollowsChangeFeed) {
+    ProductTypeahead typeahead;
+    ASSERT_TRUE(typeahead.build(db));
+    typeahead.attach(db);
+
+    Merchant merchant(7, "m", "p", "m@x.com");
+    merchant.publishProduct(db, Product(0, "Kettle", "Steel", 20.0, "k.png"));
+    merchant.publishProduct(db, Product(0, "Keyboard", "Mechanical", 50.0, "kb.png"));
+    EXPECT_EQ(suggestionIds(typeahead.complete("ke")), (std::vector<int>{1, 2}));
+
+    Customer customer(8, "c", "p", "c@x.com");
+    customer.purchaseProduct(db, 2);
+    EXPECT_EQ(suggestionIds(typeahead.complete("ke")), (std::vector<int>{2, 1}));
+
+    merchant.removeProduct(db, 2);
+    EXPECT_EQ(suggestionIds(typeahead.complete("ke")), (std::vector<int>{1}));
+    EXPECT_EQ(typeahead.size(), 1);
+    typeahead.detach();
+}
+
+// 增量数组合并、删除后压缩，结果与全量重建一致
+TEST(TypeaheadTest, IncrementalUpdatesMatchRebuild) {
+    ProductTypeahead typeahead(5);
+    const int count = ProductTypeahead::MERGE_THRESHOLD * 3;
+    for (int i = 1; i <= count; ++i) {
+        typeahead.addProduct(i, QString("item %1").arg(i % 100, 2, 10, QChar('0')) + QString::number(i));
+    }
+    for (int i = 1; i <= count; i += 2) {
+        typeahead.removeProduct(i);
+    }
+    for (int i = 2; i <= count; i += 10) {
+        typeahead.recordPurchase(i, i % 7);
+    }
+    EXPECT_EQ(typeahead.size(), count / 2);
+
+    // 手工算出 "item 4" 前缀下的期望排序：(-销量, 名称, id)
+    std::vector<std::tuple<int, std::string, int>> ranked;
+    for (int i = 2; i <= count; i += 2) {
+        std::string name = ProductTypeahead::normalize(QString("item %1").arg(i % 100, 2, 10, QChar('0')) + QString::number(i));
+        if (name.rfind("item 4", 0) == 0) {
+            int popularity = (i - 2) % 10 == 0 ? i % 7 : 0;
+            ranked.emplace_back(-popularity, name, i);
+        }
+    }
+    std::sort(ranked.begin(), ranked.end());
+    std::vector<int> want;
+    for (int k = 0; k < 5 && k < static_cast<int>(ranked.size()); ++k) {
+        want.push_back(std::get<2>(ranked[k]));
+    }
+    EXPECT_EQ(suggestionIds(typeahead.complete("Item 4", 5)), want);
+    EXPECT_EQ(suggestionIds(typeahead.complete("item 4", 5)), want);  // 第二次命中回填的缓存
+}
+
+// ========================================================
+// 子功能 13: 批量导入用户测试 (UserImporter)
+// ========================================================
+
+TEST_F(CoreSchemaTest, BulkImportReportsDuplicatesAndKeepsLoginCompatible) {
+    Customer existing(0, "alice", "secret", "alice@x.com");
+    existing.registerUser(db);
+
+    UserImporter importer(db, 2, 3);  // 小批次，覆盖多次事务和多线程哈希
+    EXPECT_TRUE(importer.add({"bob", "pw-bob", "bob@x.com", "customer"}));
+    EXPECT_TRUE(importer.add({"alice", "other", "a2@x.com", "customer"}));
+    EXPECT_TRUE(importer.add({"carol", "pw-carol", "carol@x.com", "merchant"}));
+    EXPECT_TRUE(importer.add({"bob", "again", "b2@x.com", "customer"}));
+    EXPECT_TRUE(importer.add({"dave", "pw-dave", "dave@x.com", "admin"}));
+    EXPECT_TRUE(importer.add({"erin", "pw-erin", "erin@x.com", "customer"}));
+    ASSERT_TRUE(importer.finish()) << importer.lastError().toStdString();
+
+    const ImportReport &report = importer.report();
+    EXPECT_EQ(report.imported, 3);
+    EXPECT_EQ(report.duplicates, (QStringList{"alice", "bob"}));
+    EXPECT_EQ(report.rejected, (QStringList{"dave"}));
+
+    QSqlQuery q(db);
+    q.exec("SELECT COUNT(*) FROM Users");
+    ASSERT_TRUE(q.next());
+    EXPECT_EQ(q.value(0).toInt(), 4);
+
+    Customer bob(0, "bob", "", "");
+    EXPECT_TRUE(bob.login(db, "pw-bob"));
+    Merchant carol(0, "carol", "", "");
+    EXPECT_TRUE(carol.login(db, "pw-carol"));
+    Customer alice(0, "alice", "", "");
+    EXPECT_TRUE(alice.login(db, "secret"));  // 原有账号未被覆盖
+}
+
+TEST_F(CoreSchemaTest, BulkImportReadsCsv) {
+    QTemporaryDir dir;
+    QString path = dir.filePath("users.csv");
+    {
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Text));
+        file.write("username,password,email,role\n"
+                   "frank,pw-frank,frank@x.com,customer\n"
+                   "broken line\n"
+                   "\n"
+                   "grace,pw-grace,grace@x.com,merchant\n");
+    }
+
+    UserImporter importer(db);
+    ASSERT_TRUE(importer.importCsv(path));
+    EXPECT_EQ(importer.report().imported, 2);
+    EXPECT_EQ(importer.report().rejected, (QStringList{"line 3"}));
+
+    Merchant grace(0, "grace", "", "");
+    EXPECT_TRUE(grace.login(db, "pw-grace"));
+}
+
+TEST_F(CoreSchemaTest, BulkImportParsesQuotedCsvFields) {
+    QTemporaryDir dir;
+    QString path = dir.filePath("users.csv");
+    {
+        QFile file(path);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Text));
+        file.write("username,password,email,role\n"
+                   "\"henry\",\"pw,with,commas\",henry@x.com,customer\n"
+                   "ivy,\"say \"\"hi\"\"\",ivy@x.com,\"merchant\"\n"
+                   "jack,\"two\nlines\",jack@x.com,customer\n"
+                   "kate,\"a,b\",kate@x.com\n"
+                   "liam,pw-liam,liam@x.com,customer\n"
+                   "mia,\"unterminated,mia@x.com,customer\n");
+    }
+
+    UserImporter importer(db);
+    ASSERT_TRUE(importer.importCsv(path)) << importer.lastError().toStdString();
+    EXPECT_EQ(importer.report().imported, 4);
+    // 跨行记录之后的行号仍按物理行计算
+    EXPECT_EQ(importer.report().rejected, (QStringList{"line 6", "line 8"}));
+
+    Customer henry(0, "henry", "", "");
+    EXPECT_TRUE(henry.login(db, "pw,with,commas"));
+    Merchant ivy(0, "ivy", "", "");
+    EXPECT_TRUE(ivy.login(db, "say \"hi\""));
+    Customer jack(0, "jack", "", "");
+    EXPECT_TRUE(jack.login(db, "two\nlines"));
+    Customer liam(0, "liam", "", "");
+    EXPECT_TRUE(liam.login(db, "pw-liam"));
+}
+
+TEST_F(CoreSchemaTest, UsernameIsUniqueInSchema) {
+    Customer first(0, "nora", "pw-1", "n1@x.com");
+    EXPECT_EQ(first.registerUser(db), RegistrationResult::Registered);
+    Merchant second(0, "nora", "pw-2", "n2@x.com");
+    EXPECT_EQ(second.registerUser(db), RegistrationResult::UsernameTaken);  // 被唯一索引拒绝
+
+    QSqlQuery q(db);
+    q.exec("SELECT COUNT(*) FROM Users WHERE username = 'nora'");
+    ASSERT_TRUE(q.next());
+    EXPECT_EQ(q.value(0).toInt(), 1);
+    EXPECT_TRUE(first.login(db, "pw-1"));
+}
+
+// ========================================================
+// 子功能 14: 密码哈希参数测试 (User)
+// ========================================================
+
+static int storedIterations(QSqlDatabase &db, const QString &username) {
+    QSqlQuery q(db);
+    q.prepare("SELECT iterations FROM Users WHERE username = :username");
+    q.bindValue(":username", username);
+    return q.exec() && q.next() ? q.value(0).toInt() : -1;
+}
+
+TEST_F(CoreSchemaTest, PerUserHashCostsCoexistAndUpgradeOnLogin) {
+    User::setDefaultIterations(2000);
+    Customer weak(0, "weak", "pw-weak", "w@x.com");
+    weak.registerUser(db);
+    User::setDefaultIterations(3000);
+    Customer strong(0, "strong", "pw-strong", "s@x.com");
+    strong.registerUser(db);
+    EXPECT_EQ(storedIterations(db, "weak"), 2000);
+    EXPECT_EQ(storedIterations(db, "strong"), 3000);
+
+    // 低于当前配置的记录在登录成功后升级
+    Customer weakLogin(0, "weak", "", "");
+    EXPECT_TRUE(weakLogin.login(db, "pw-weak"));
+    EXPECT_EQ(storedIterations(db, "weak"), 3000);
+    EXPECT_TRUE(weakLogin.login(db, "pw-weak"));
+
+    // 降低配置不会降级已有记录，旧参数照样能登录
+    User::setDefaultIterations(User::MIN_PBKDF2_ITERATIONS);
+    Customer strongLogin(0, "strong", "", "");
+    EXPECT_TRUE(strongLogin.login(db, "pw-strong"));
+    EXPECT_FALSE(strongLogin.login(db, "wrong"));
+    EXPECT_EQ(storedIterations(db, "strong"), 3000);
+    User::setDefaultIterations(User::DEFAULT_PBKDF2_ITERATIONS);
+}
+
+TEST(PasswordHashingTest, CalibrationAndConfiguration) {
+    int quick = User::calibrateIterations(1);
+    int slow = User::calibrateIterations(50);
+    EXPECT_GE(quick, User::MIN_PBKDF2_ITERATIONS);
+    EXPECT_LE(slow, User::MAX_PBKDF2_ITERATIONS);
+    EXPECT_GE(slow, quick);
+
+    QTemporaryDir dir;
+    {
+        QSettings settings(dir.filePath("fixed.ini"), QSettings::IniFormat);
+        settings.setValue("security/hashIterations", 4000);
+        settings.sync();
+        User::configureHashing(settings);
+        EXPECT_EQ(User::defaultIterations(), 4000);
+    }
+    {
+        // 未配置时保持当前值
+        QSettings settings(dir.filePath("empty.ini"), QSettings::IniFormat);
+        User::configureHashing(settings);
+        EXPECT_EQ(User::defaultIterations(), 4000);
+    }
+    User::setDefaultIterations(User::DEFAULT_PBKDF2_ITERATIONS);
+}
+
+// ========================================================
+// 子功能 15: 顾客订单历史测试 (Customer::orderHistory)
+// ========================================================
+
+TEST_F(CoreSchemaTest, OrderHistoryPagesByKeysetCursor) {
+    QSqlQuery q(db);
+    q.exec("INSERT INTO Products (productId, name, price) VALUES (1, 'Pen', 1.0), (2, 'Ink', 2.0), (3, 'Gone', 3.0)");
+    // 两条订单同一时间，验证 orderId 作为第二排序键
+    q.exec("INSERT INTO Orders (orderId, customerId, productId, quantity, orderDate) VALUES "
+           "(1, 5, 1, 1, '2030-01-01T10:00:00Z'), (2, 5, 2, 2, '2030-01-02T10:00:00Z'), "
+           "(3, 5, 1, 1, '2030-01-02T10:00:00Z'), (4, 6, 1, 1, '2030-01-03T10:00:00Z'), "
+           "(5, 5, 3, 1, '2030-01-04T10:00:00Z')");
+    q.exec("DELETE FROM Products WHERE productId = 3");
+
+    Customer customer(5, "c", "p", "c@x.com");
+    QList<int> seen;
+    OrderCursor cursor;
+    int pages = 0;
+    for (;;) {
+        OrderHistoryPage page = customer.orderHistory(db, 2, cursor);
+        ++pages;
+        for (const OrderHistoryEntry &entry : page.orders) {
+            seen << entry.orderId;
+        }
+        if (!page.hasMore) {
+            break;
+        }
+        cursor = page.next;
+    }
+    EXPECT_EQ(seen, (QList<int>{5, 3, 2, 1}));
+    EXPECT_EQ(pages, 2);
+
+    OrderHistoryPage first = customer.orderHistory(db, 10);
+    ASSERT_EQ(first.orders.size(), 4);
+    EXPECT_TRUE(first.orders[0].productName.isEmpty());  // 已下架
+    EXPECT_EQ(first.orders[1].productName, "Pen");
+    EXPECT_EQ(first.orders[2].productName, "Ink");
+    EXPECT_EQ(first.orders[2].quantity, 2);
+
+    // 日期范围 [from, to)
+    OrderHistoryPage ranged = customer.orderHistory(db, 10, OrderCursor(), "2030-01-02T00:00:00Z", "2030-01-04T00:00:00Z");
+    QList<int> rangedIds;
+    for (const OrderHistoryEntry &entry : ranged.orders) {
+        rangedIds << entry.orderId;
+    }
+    EXPECT_EQ(rangedIds, (QList<int>{3, 2}));
+    EXPECT_FALSE(ranged.hasMore);
+
+    // 显式传空字符串表示不限日期
+    OrderHistoryPage unbounded = customer.orderHistory(db, 10, OrderCursor(), QString(""), QString(""));
+    EXPECT_EQ(unbounded.orders.size(), 4);
+    OrderHistoryPage openStart = customer.orderHistory(db, 10, OrderCursor(), QString(), "2030-01-02T00:00:00Z");
+    ASSERT_EQ(openStart.orders.size(), 1);
+    EXPECT_EQ(openStart.orders[0].orderId, 1);
+}
+
 // ========================================================
 // 集成测试组 1: 商家管理商品全流程 (Merchant + Product + DB)
 // ========================================================
@@ -327,6 +1592,184 @@ TEST_F(ShopLinkTest, Integration_CustomerBuysMerchantProduct) {
     buyer.purchaseProduct(db, productId);
 }
 
+// ========================================================
+// 大数据量测试：基于模板库克隆的夹具
+// ========================================================
+
+class ShopLinkScaleTest : public ::testing::Test {
+protected:
+    QSqlDatabase db;
+
+    void SetUp() override {
+        db = TestDatabaseFactory::openClone("scale");
+        ASSERT_TRUE(db.isOpen());
+    }
+
+    void TearDown() override {
+        db = QSqlDatabase();
+        TestDatabaseFactory::closeClone("scale");
+    }
+};
+
+TEST_F(ShopLinkScaleTest, CloneContainsSeededCatalog) {
+    SeedSpec spec;
+    QSqlQuery q(db);
+    q.exec("SELECT COUNT(*) FROM Products");
+    ASSERT_TRUE(q.next());
+    EXPECT_EQ(q.value(0).toInt(), spec.products);
+
+    q.exec("SELECT COUNT(*) FROM Users");
+    ASSERT_TRUE(q.next());
+    EXPECT_EQ(q.value(0).toInt(), spec.users);
+}
+
+TEST_F(ShopLinkScaleTest, SeededUsersLogInWithRealHashes) {
+    Customer customer(0, TestDatabaseFactory::seededUsername(1), "", "");
+    EXPECT_TRUE(customer.login(db, TestDatabaseFactory::seededPassword(1)));
+    EXPECT_EQ(customer.getUserId(), 1);
+    EXPECT_FALSE(customer.login(db, "wrong"));
+}
+
+// 每个测试拿到独立拷贝：修改不会影响下一次克隆
+TEST_F(ShopLinkScaleTest, ClonesAreIsolated) {
+    QSqlQuery q(db);
+    ASSERT_TRUE(q.exec("DELETE FROM Products"));
+
+    QSqlDatabase other = TestDatabaseFactory::openClone("scale_other");
+    {
+        QSqlQuery check(other);
+        check.exec("SELECT COUNT(*) FROM Products");
+        ASSERT_TRUE(check.next());
+        EXPECT_EQ(check.value(0).toInt(), SeedSpec().products);
+    }
+    other = QSqlDatabase();
+    TestDatabaseFactory::closeClone("scale_other");
+}
+
+// 种子顾客的完整历史逐页读出，顺序与全量排序一致
+TEST_F(ShopLinkScaleTest, OrderHistoryWalksSeededCustomer) {
+    Customer customer(1, TestDatabaseFactory::seededUsername(1), "", "");
+    QList<int> paged;
+    OrderCursor cursor;
+    for (;;) {
+        OrderHistoryPage page = customer.orderHistory(db, 7, cursor);
+        for (const OrderHistoryEntry &entry : page.orders) {
+            paged << entry.orderId;
+            EXPECT_FALSE(entry.productName.isEmpty());
+        }
+        if (!page.hasMore) {
+            break;
+        }
+        cursor = page.next;
+    }
+
+    QList<int> expected;
+    QSqlQuery q(db);
+    q.exec("SELECT orderId FROM Orders WHERE customerId = 1 ORDER BY orderDate DESC, orderId DESC");
+    while (q.next()) {
+        expected << q.value(0).toInt();
+    }
+    EXPECT_EQ(paged.size(), SeedSpec().ordersPerCustomer);
+    EXPECT_EQ(paged, expected);
+}
+
+// EXPLAIN QUERY PLAN 的 detail 列；占位符统一绑定 1（计划与取值无关）
+static QStringList queryPlan(QSqlDatabase &db, const QString &sql) {
+    QSqlQuery q(db);
+    if (!q.prepare("EXPLAIN QUERY PLAN " + sql)) {
+        return {"ERROR " + q.lastError().text()};
+    }
+    static const QRegularExpression placeholder(":(\\w+)");
+    QRegularExpressionMatchIterator it = placeholder.globalMatch(sql);
+    while (it.hasNext()) {
+        q.bindValue(":" + it.next().captured(1), 1);
+    }
+    for (int i = sql.count('?'); i > 0; --i) {
+        q.addBindValue(1);  // 位置参数
+    }
+    if (!q.exec()) {
+        return {"ERROR " + q.lastError().text()};
+    }
+    QStringList details;
+    while (q.next()) {
+        details << q.value(3).toString();
+    }
+    return details;
+}
+
+// 热路径 SQL 守卫：登记为走索引的语句在种子库上不得出现全表扫描
+TEST_F(ShopLinkScaleTest, HotQueriesUseExpectedAccessPath) {
+    for (const HotQuery &hot : HotQueries::all()) {
+        QStringList plan = queryPlan(db, hot.sql);
+        ASSERT_FALSE(plan.isEmpty()) << hot.name;
+        for (const QString &detail : plan) {
+            EXPECT_FALSE(detail.startsWith("ERROR")) << hot.name << ": " << detail.toStdString();
+            if (hot.expected == AccessPath::Index) {
+                EXPECT_FALSE(detail.startsWith("SCAN")) << hot.name << " scans: " << plan.join("; ").toStdString();
+                // 索引顺序不满足 ORDER BY/GROUP BY/DISTINCT 时会先把整个结果集排序
+                EXPECT_FALSE(detail.contains("USE TEMP B-TREE"))
+                    << hot.name << " sorts: " << plan.join("; ").toStdString();
+            }
+        }
+    }
+
+    // 守卫本身能识别全表扫描和临时排序
+    QStringList unindexed = queryPlan(db, "SELECT userId FROM Users WHERE email = :email");
+    ASSERT_FALSE(unindexed.isEmpty());
+    EXPECT_TRUE(unindexed.first().startsWith("SCAN"));
+    QStringList sorted = queryPlan(db, "SELECT orderId FROM Orders WHERE customerId = :customerId ORDER BY quantity");
+    EXPECT_TRUE(sorted.join("; ").contains("USE TEMP B-TREE")) << sorted.join("; ").toStdString();
+}
+
+// 公共前缀很长的 10 万个商品名上，热门前缀从第一次查询起就命中缓存，其余前缀扫描不超过 HOT_RANGE 条；
+// 删除热门商品后缓存就地重算，同样不超过 HOT_RANGE 条。不计时：用扫描条目数衡量，覆盖率构建下同样稳定
+TEST_F(ShopLinkScaleTest, TypeaheadCompletesWithinBudget) {
+    ProductTypeahead typeahead;
+    ASSERT_TRUE(typeahead.build(db));
+    ASSERT_EQ(typeahead.size(), SeedSpec().products);
+
+    // 名称为 "Product 000001".."Product 100000"：前五个前缀命中范围都超过 HOT_RANGE
+    const QStringList hot = {"p", "pr", "product", "product 0", "product 01"};
+    const QStringList narrow = {"product 012", "product 0123"};
+
+    // 冷查询：热门前缀在 build() 时已缓存
+    for (int r = 0; r < 3; ++r) {
+        for (const QString &prefix : hot) {
+            quint64 before = typeahead.scannedEntries();
+            ASSERT_FALSE(typeahead.complete(prefix).empty());
+            EXPECT_EQ(typeahead.scannedEntries(), before) << "hot prefix rescanned: " << prefix.toStdString();
+        }
+        for (const QString &prefix : narrow) {
+            quint64 before = typeahead.scannedEntries();
+            ASSERT_FALSE(typeahead.complete(prefix).empty());
+            EXPECT_LE(typeahead.scannedEntries() - before, static_cast<quint64>(ProductTypeahead::HOT_RANGE))
+                << prefix.toStdString();
+        }
+    }
+
+    // 删掉热门前缀下排第一的商品：删除本身有界，之后的查询仍命中缓存，且与全范围扫描的结果一致
+    for (const QString &prefix : hot) {
+        int first = typeahead.complete(prefix).front().productId;
+        quint64 before = typeahead.scannedEntries();
+        typeahead.removeProduct(first);
+        EXPECT_LE(typeahead.scannedEntries() - before, static_cast<quint64>(ProductTypeahead::HOT_RANGE))
+            << "remove under " << prefix.toStdString();
+
+        for (const QString &check : hot + narrow) {
+            before = typeahead.scannedEntries();
+            std::vector<int> cached = suggestionIds(typeahead.complete(check));
+            if (hot.contains(check)) {
+                EXPECT_EQ(typeahead.scannedEntries(), before) << "rescanned after remove: " << check.toStdString();
+            }
+            EXPECT_EQ(std::count(cached.begin(), cached.end(), first), 0) << check.toStdString();
+
+            std::vector<int> scanned = suggestionIds(typeahead.complete(check, ProductTypeahead::DEFAULT_LIMIT + 1));
+            scanned.resize(std::min(scanned.size(), cached.size()));
+            EXPECT_EQ(cached, scanned) << check.toStdString();
+        }
+    }
+}
+
 int main(int argc, char *argv[]) {
     QCoreApplication app(argc, argv);
     ::testing::InitGoogleTest(&argc, argv);
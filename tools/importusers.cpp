@@ -0,0 +1,44 @@
+#include <QCoreApplication>
+#include <QSqlDatabase>
+#include <QTextStream>
+#include "core/schema.h"
+#include "core/userimporter.h"
+
+// 用法：ShopLinkImport <数据库文件> <users.csv>
+// CSV 每条记录 username,password,email,role，可带表头；含逗号、引号或换行的字段用双引号包围
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+    QStringList args = app.arguments();
+    if (args.size() != 3) {
+        err << "Usage: ShopLinkImport <database> <users.csv>\n";
+        return 2;
+    }
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+    db.setDatabaseName(args[1]);
+    if (!db.open()) {
+        err << "Failed to open database " << args[1] << "\n";
+        return 1;
+    }
+    createTables(db);
+
+    UserImporter importer(db);
+    bool ok = importer.importCsv(args[2]);
+    const ImportReport &report = importer.report();
+    out << "Imported: " << report.imported << "\n";
+    out << "Duplicate usernames: " << report.duplicates.size() << "\n";
+    for (const QString &name : report.duplicates) {
+        out << "  " << name << "\n";
+    }
+    out << "Rejected records: " << report.rejected.size() << "\n";
+    for (const QString &name : report.rejected) {
+        out << "  " << name << "\n";
+    }
+    if (!ok) {
+        err << "Import stopped: " << importer.lastError() << "\n";
+        return 1;
+    }
+    return 0;
+}